@@ -0,0 +1,96 @@
+/**
+ * @file bench.cpp
+ * @brief On-target micro-benchmark harness implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "bench.hpp"
+#include "system.hpp"
+
+namespace embedded {
+namespace bench {
+
+namespace {
+
+constexpr u32 CALIBRATION_RUNS = 64;
+
+} // namespace
+
+hal::UART* Bench::s_uart = nullptr;
+u32 Bench::s_overhead = 0;
+u32 Bench::s_results = 0;
+
+void Bench::init(hal::UART* uart) {
+    s_uart = uart;
+    s_results = 0;
+    calibrate();
+
+    print("BENCH_BEGIN");
+    printField(System::getSystemClock());
+    print("\r\n");
+}
+
+void Bench::finish() {
+    print("BENCH_END");
+    printField(s_results);
+    print("\r\n");
+    s_uart->flushTx();
+}
+
+void Bench::skip(const char* name, Status status) {
+    print("BENCH_SKIP,");
+    print(name);
+    printField(static_cast<u32>(status));
+    print("\r\n");
+}
+
+void Bench::report(const char* name, Stats stats, u32 bytes, bool timed) {
+    if (timed) {
+        // The overhead was measured with the same instruction sequence,
+        // so an empty function reports 0 rather than wrapping
+        stats.min = (stats.min > s_overhead) ? stats.min - s_overhead : 0;
+        stats.max = (stats.max > s_overhead) ? stats.max - s_overhead : 0;
+        u64 removed = static_cast<u64>(s_overhead) * stats.count;
+        stats.total = (stats.total > removed) ? stats.total - removed : 0;
+    }
+
+    print("BENCH,");
+    print(name);
+    printField(stats.count);
+    printField(stats.min);
+    printField(stats.mean());
+    printField(stats.max);
+    printField(bytes);
+    print("\r\n");
+    s_results++;
+}
+
+void Bench::calibrate() {
+    Stats stats;
+    for (u32 i = 0; i < CALIBRATION_RUNS; i++) {
+        u32 start = cycles();
+        stats.add(cycles() - start);
+    }
+    s_overhead = stats.min;
+}
+
+void Bench::print(const char* str) {
+    s_uart->print(str);
+}
+
+void Bench::printField(u32 value) {
+    char text[12];
+    char* p = &text[sizeof(text) - 1];
+    *p = '\0';
+    do {
+        *--p = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    *--p = ',';
+    print(p);
+}
+
+} // namespace bench
+} // namespace embedded
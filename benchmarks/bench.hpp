@@ -0,0 +1,152 @@
+/**
+ * @file bench.hpp
+ * @brief On-target micro-benchmark harness
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include "types.hpp"
+#include "hal/uart.hpp"
+
+namespace embedded {
+namespace bench {
+
+/**
+ * @brief Read the DWT cycle counter
+ *
+ * Inline so the measurement itself costs a single load; System::init()
+ * must have enabled the counter.
+ *
+ * @return Current CYCCNT value
+ */
+inline u32 cycles() {
+    return *reinterpret_cast<volatile u32*>(0xE0001004);
+}
+
+/**
+ * @brief Min/mean/max accumulator for cycle samples
+ */
+struct Stats {
+    u32 count = 0;
+    u32 min   = 0xFFFFFFFF;
+    u32 max   = 0;
+    u64 total = 0;
+
+    /**
+     * @brief Add one sample
+     * @param sample Cycle count
+     */
+    void add(u32 sample) {
+        if (sample < min) min = sample;
+        if (sample > max) max = sample;
+        total += sample;
+        count++;
+    }
+
+    /**
+     * @brief Get the mean sample
+     * @return Mean in cycles (0 without samples)
+     */
+    u32 mean() const { return count ? static_cast<u32>(total / count) : 0; }
+};
+
+/**
+ * @class Bench
+ * @brief Runs measurements and reports them over a UART
+ *
+ * Every result is one CSV line, so a capture of the debug UART can be
+ * compared between releases with tools/bench_compare.py:
+ *
+ *     BENCH_BEGIN,<sysclk_hz>
+ *     BENCH,<name>,<iterations>,<min>,<mean>,<max>,<bytes>
+ *     BENCH_SKIP,<name>,<status>
+ *     BENCH_END,<results>
+ *
+ * Cycle counts have the measurement overhead (an empty call) removed.
+ * bytes is the payload per iteration for throughput tests, 0 otherwise.
+ * Reporting uses polled UART transmission and only runs between
+ * measurements.
+ */
+class Bench {
+public:
+    /**
+     * @brief Initialize the harness and print BENCH_BEGIN
+     * @param uart Initialized report UART
+     */
+    static void init(hal::UART* uart);
+
+    /**
+     * @brief Print BENCH_END
+     */
+    static void finish();
+
+    /**
+     * @brief Time a function
+     * @param name Result name (no commas)
+     * @param iterations Number of timed calls
+     * @param fn Function to time, called once per iteration
+     * @param bytes Payload bytes per call (throughput tests)
+     */
+    template <typename Fn>
+    static void measure(const char* name, u32 iterations, Fn fn, u32 bytes = 0) {
+        Stats stats;
+        fn();                               // Warm caches and prefetch buffer
+        for (u32 i = 0; i < iterations; i++) {
+            u32 start = cycles();
+            fn();
+            stats.add(cycles() - start);
+        }
+        report(name, stats, bytes, true);
+    }
+
+    /**
+     * @brief Collect samples measured by the function itself
+     *
+     * For latencies that do not fit a call (e.g. ISR entry), @p fn
+     * returns the sample in cycles.
+     *
+     * @param name Result name (no commas)
+     * @param iterations Number of samples
+     * @param fn Function returning one sample
+     */
+    template <typename Fn>
+    static void sample(const char* name, u32 iterations, Fn fn) {
+        Stats stats;
+        for (u32 i = 0; i < iterations; i++) {
+            stats.add(fn());
+        }
+        report(name, stats, 0, false);
+    }
+
+    /**
+     * @brief Report a benchmark that could not run
+     * @param name Result name
+     * @param status Failure status
+     */
+    static void skip(const char* name, Status status);
+
+    /**
+     * @brief Get the calibrated measurement overhead
+     * @return Cycles of an empty measure() iteration
+     */
+    static u32 getOverhead() { return s_overhead; }
+
+private:
+    static hal::UART* s_uart;
+    static u32 s_overhead;
+    static u32 s_results;
+
+    static void report(const char* name, Stats stats, u32 bytes, bool timed);
+    static void calibrate();
+    static void print(const char* str);
+    static void printField(u32 value);
+};
+
+} // namespace bench
+} // namespace embedded
+
+#endif // BENCH_HPP
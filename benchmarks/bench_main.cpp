@@ -0,0 +1,283 @@
+/**
+ * @file bench_main.cpp
+ * @brief HAL hot-path benchmark firmware
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ *
+ * Runs the suite once after reset and prints one BENCH line per result
+ * on the debug UART (see bench.hpp for the format). All numbers are core
+ * cycles at the configured system clock.
+ *
+ * Hardware Setup:
+ *   - UART TX on PA2 (USART2), captured by the host
+ *   - SPI1 with MOSI looped to MISO (or any slave)
+ *   - I2C1 with a device at BENCH_I2C_ADDR (skipped if absent)
+ */
+
+#include "bench.hpp"
+#include "system.hpp"
+#include "hal/gpio.hpp"
+#include "hal/gpio_pin.hpp"
+#include "hal/uart.hpp"
+#include "hal/spi.hpp"
+#include "hal/i2c.hpp"
+
+using namespace embedded;
+using namespace embedded::hal;
+using namespace embedded::bench;
+
+/*============================================================================
+ * Hardware Configuration
+ *===========================================================================*/
+// Adjust these for your board
+#define BENCH_UART          DEBUG_UART_PORT
+#define BENCH_SPI           SPI1
+#define BENCH_I2C           I2C1
+
+#ifndef BENCH_I2C_ADDR
+#define BENCH_I2C_ADDR      0x68            // MPU-6050
+#endif
+#ifndef BENCH_I2C_REG
+#define BENCH_I2C_REG       0x75            // WHO_AM_I
+#endif
+
+#define BENCH_ITERATIONS    256
+#define BENCH_IO_ITERATIONS 16              // Tests bounded by bus speed
+#define BENCH_PAYLOAD       64              // UART payload (bytes)
+#define BENCH_SPI_PAYLOAD   256             // SPI payload (bytes)
+
+using PinA5 = GpioPin<PortId::A, 5>;
+
+/*============================================================================
+ * Test Data
+ *===========================================================================*/
+static u8 txBuffer[BENCH_SPI_PAYLOAD];
+static u8 rxBuffer[BENCH_SPI_PAYLOAD];
+
+static volatile bool txDone;
+static volatile u32 isrEntry;
+
+/**
+ * @brief Fill the transmit buffer with a printable pattern
+ */
+static void fillBuffer() {
+    for (size_t i = 0; i < sizeof(txBuffer); i++) {
+        txBuffer[i] = static_cast<u8>('A' + i % 26);
+    }
+}
+
+/*============================================================================
+ * GPIO
+ *===========================================================================*/
+static void benchGpio() {
+    GPIO pin = PinA5::toGpio();
+    pin.setMode(GPIO::Mode::Output);
+    pin.setSpeed(GPIO::Speed::VeryHigh);
+
+    Bench::measure("gpio_toggle", BENCH_ITERATIONS, [&]() { pin.toggle(); });
+    Bench::measure("gpio_set_high", BENCH_ITERATIONS, [&]() { pin.setHigh(); });
+    Bench::measure("gpio_pin_toggle", BENCH_ITERATIONS, []() { PinA5::toggle(); });
+
+    GPIO::Group group = GpioPort<PortId::A>::group(0x00F0);
+    u16 value = 0;
+    Bench::measure("gpio_group_write", BENCH_ITERATIONS, [&]() { group.write(value += 0x10); });
+}
+
+/*============================================================================
+ * UART
+ *===========================================================================*/
+static void onTxDone(void* context) {
+    UNUSED(context);
+    txDone = true;
+}
+
+static void benchUart(UART& uart) {
+    // Payloads are written to the capture; the host ignores non-BENCH lines
+    txBuffer[BENCH_PAYLOAD - 2] = '\r';
+    txBuffer[BENCH_PAYLOAD - 1] = '\n';
+
+    Bench::measure("uart_tx_poll", BENCH_IO_ITERATIONS, [&]() {
+        uart.transmit(txBuffer, BENCH_PAYLOAD);
+        uart.flushTx();
+    }, BENCH_PAYLOAD);
+
+    // Call cost and time to completion are reported separately: the
+    // first is CPU time, the second is bounded by the baud rate
+    Bench::sample("uart_tx_it_call", BENCH_IO_ITERATIONS, [&]() {
+        txDone = false;
+        u32 start = cycles();
+        uart.transmitIT(txBuffer, BENCH_PAYLOAD, onTxDone);
+        u32 elapsed = cycles() - start - Bench::getOverhead();
+        while (!txDone) {}
+        return elapsed;
+    });
+    Bench::measure("uart_tx_it_done", BENCH_IO_ITERATIONS, [&]() {
+        txDone = false;
+        uart.transmitIT(txBuffer, BENCH_PAYLOAD, onTxDone);
+        while (!txDone) {}
+    }, BENCH_PAYLOAD);
+
+    // Reinitialize with the DMA TX ring
+    UART::Config config;
+    config.baudRate = DEBUG_UART_BAUDRATE;
+    config.txDma = true;
+    uart.deinit();
+    Status status = uart.init(config);
+    if (status != Status::Ok) {
+        config.txDma = false;
+        uart.init(config);
+        Bench::skip("uart_tx_dma", status);
+        return;
+    }
+
+    Bench::sample("uart_tx_dma_call", BENCH_IO_ITERATIONS, [&]() {
+        u32 start = cycles();
+        uart.transmitDMA(txBuffer, BENCH_PAYLOAD);
+        u32 elapsed = cycles() - start - Bench::getOverhead();
+        uart.flushTx();
+        return elapsed;
+    });
+    Bench::measure("uart_tx_dma_done", BENCH_IO_ITERATIONS, [&]() {
+        uart.transmitDMA(txBuffer, BENCH_PAYLOAD);
+        uart.flushTx();
+    }, BENCH_PAYLOAD);
+}
+
+/*============================================================================
+ * SPI
+ *===========================================================================*/
+static void benchSpi() {
+    static const char* const names[] = {
+        "spi_xfer_div2",  "spi_xfer_div4",  "spi_xfer_div8",   "spi_xfer_div16",
+        "spi_xfer_div32", "spi_xfer_div64", "spi_xfer_div128", "spi_xfer_div256"
+    };
+
+    SPI spi(BENCH_SPI);
+    SPI::Config config;
+    Status status = spi.init(config);
+    if (status != Status::Ok) {
+        Bench::skip("spi_xfer", status);
+        return;
+    }
+
+    for (u32 i = 0; i < ARRAY_SIZE(names); i++) {
+        spi.setClockFrequency(System::getApb2Clock() >> (i + 1));
+        Bench::measure(names[i], BENCH_IO_ITERATIONS, [&]() {
+            spi.transfer(txBuffer, rxBuffer, BENCH_SPI_PAYLOAD);
+        }, BENCH_SPI_PAYLOAD);
+    }
+
+    spi.setClockFrequency(System::getApb2Clock() / 2);
+    Bench::measure("spi_byte", BENCH_ITERATIONS, [&]() { spi.transfer(txBuffer[0]); });
+
+    spi.deinit();
+}
+
+/*============================================================================
+ * I2C
+ *===========================================================================*/
+static void benchI2c() {
+    I2C i2c(BENCH_I2C);
+    I2C::Config config;
+    config.speed = I2C::Speed::Fast;
+    Status status = i2c.init(config);
+
+    u8 value = 0;
+    if (status == Status::Ok) {
+        status = i2c.readRegister(BENCH_I2C_ADDR, BENCH_I2C_REG, &value);
+    }
+    if (status != Status::Ok) {
+        Bench::skip("i2c_read_reg", status);
+        i2c.deinit();
+        return;
+    }
+
+    Bench::measure("i2c_read_reg", BENCH_IO_ITERATIONS, [&]() {
+        i2c.readRegister(BENCH_I2C_ADDR, BENCH_I2C_REG, &value);
+    }, 1);
+    Bench::measure("i2c_read_reg6", BENCH_IO_ITERATIONS, [&]() {
+        i2c.readRegister(BENCH_I2C_ADDR, BENCH_I2C_REG, rxBuffer, static_cast<size_t>(6));
+    }, 6);
+
+    i2c.deinit();
+}
+
+/*============================================================================
+ * Critical Sections and Interrupts
+ *===========================================================================*/
+static void benchCritical() {
+    Bench::measure("critical_primask", BENCH_ITERATIONS, []() { CriticalSection cs; });
+    Bench::measure("critical_basepri", BENCH_ITERATIONS, []() {
+        CriticalSection cs(IrqPriority::Medium);
+    });
+}
+
+/**
+ * @brief ISR entry latency probe
+ *
+ * TIM7 is otherwise unused and is pended from software, so the sample
+ * covers the NVIC pend write, stacking and the vector fetch.
+ */
+extern "C" void TIM7_IRQHandler(void) {
+    isrEntry = cycles();
+}
+
+static void benchIsr() {
+    System::setIrqPriority(IrqNumber::Tim7, IrqPriority::Highest);
+    System::enableIrq(IrqNumber::Tim7);
+
+    Bench::sample("isr_latency", BENCH_ITERATIONS, []() {
+        isrEntry = 0;
+        u32 start = cycles();
+        System::setIrqPending(IrqNumber::Tim7);
+        while (isrEntry == 0) {}
+        return isrEntry - start - Bench::getOverhead();
+    });
+
+    Bench::measure("isr_roundtrip", BENCH_ITERATIONS, []() {
+        isrEntry = 0;
+        System::setIrqPending(IrqNumber::Tim7);
+        while (isrEntry == 0) {}
+    });
+
+    System::disableIrq(IrqNumber::Tim7);
+}
+
+/*============================================================================
+ * Main
+ *===========================================================================*/
+int main() {
+    if (System::init() != Status::Ok) {
+        while (true) {
+            // Error handler
+        }
+    }
+
+    UART uart(BENCH_UART);
+    UART::Config config;
+    config.baudRate = DEBUG_UART_BAUDRATE;
+    if (uart.init(config) != Status::Ok) {
+        while (true) {
+            // No report channel
+        }
+    }
+
+    fillBuffer();
+    Bench::init(&uart);
+
+    benchGpio();
+    benchCritical();
+    benchIsr();
+    benchSpi();
+    benchI2c();
+    benchUart(uart);
+
+    Bench::finish();
+
+    while (true) {
+        System::sleep();
+    }
+
+    return 0;
+}
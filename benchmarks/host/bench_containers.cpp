@@ -0,0 +1,98 @@
+/**
+ * @file bench_containers.cpp
+ * @brief Host benchmarks: ring buffer and memory pools
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "ring_buffer.hpp"
+#include "memory.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace embedded;
+
+/*============================================================================
+ * RingBuffer
+ *===========================================================================*/
+static void BM_RingBufferPushPop(benchmark::State& state) {
+    RingBuffer<u8, 256> ring;
+    u8 value = 0;
+    for (auto _ : state) {
+        ring.push(value++);
+        ring.pop(value);
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RingBufferPushPop);
+
+static void BM_RingBufferBlock(benchmark::State& state) {
+    RingBuffer<u8, 256> ring;
+    u8 block[256] = {};
+    size_t length = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        ring.pushN(block, length);
+        ring.popN(block, length);
+        benchmark::DoNotOptimize(block);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * length));
+}
+BENCHMARK(BM_RingBufferBlock)->Arg(16)->Arg(64)->Arg(256);
+
+static void BM_RingBufferSpan(benchmark::State& state) {
+    RingBuffer<u8, 256> ring;
+    for (auto _ : state) {
+        u8* write;
+        size_t space = ring.writeSpan(write);
+        ring.commit(space);
+        const u8* read;
+        size_t queued = ring.readSpan(read);
+        ring.consume(queued);
+        benchmark::DoNotOptimize(queued);
+    }
+}
+BENCHMARK(BM_RingBufferSpan);
+
+/*============================================================================
+ * Memory Pools
+ *===========================================================================*/
+static void BM_PoolAllocateFree(benchmark::State& state) {
+    size_t size = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        void* block = Memory::allocate(size);
+        benchmark::DoNotOptimize(block);
+        Memory::free(block);
+    }
+}
+BENCHMARK(BM_PoolAllocateFree)->Arg(MEMORY_POOL_SMALL_SIZE)->Arg(MEMORY_POOL_MEDIUM_SIZE)
+                              ->Arg(MEMORY_POOL_LARGE_SIZE);
+
+static void BM_PoolExhaust(benchmark::State& state) {
+    Pool& pool = Memory::getPool(Memory::PoolId::Small);
+    void* blocks[MEMORY_POOL_SMALL_COUNT];
+    for (auto _ : state) {
+        size_t count = 0;
+        while (count < MEMORY_POOL_SMALL_COUNT && (blocks[count] = pool.allocate()) != nullptr) {
+            count++;
+        }
+        for (size_t i = 0; i < count; i++) {
+            pool.free(blocks[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * MEMORY_POOL_SMALL_COUNT);
+}
+BENCHMARK(BM_PoolExhaust);
+
+static void BM_ArenaAllocate(benchmark::State& state) {
+    Arena& arena = Memory::getArena();
+    for (auto _ : state) {
+        void* block = arena.allocate(24, 8);
+        if (block == nullptr) {
+            arena.reset();
+        }
+        benchmark::DoNotOptimize(block);
+    }
+}
+BENCHMARK(BM_ArenaAllocate);
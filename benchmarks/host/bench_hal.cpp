@@ -0,0 +1,211 @@
+/**
+ * @file bench_hal.cpp
+ * @brief Host benchmarks: GPIO, CRC, critical sections and interrupt delivery
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ *
+ * Host timings say nothing about cycles on the target (use the on-target
+ * suite for that); they track the cost of the driver logic itself and
+ * exercise it under the sanitizers.
+ */
+
+#include "system.hpp"
+#include "profiler.hpp"
+#include "hal/gpio.hpp"
+#include "hal/gpio_pin.hpp"
+#include "hal/crc.hpp"
+#include "drivers/led_bank.hpp"
+#include "sim/sim.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace embedded;
+using namespace embedded::hal;
+
+namespace {
+
+using Marker = GpioPin<PortId::B, 7>;
+
+volatile u32 s_handled;
+
+void onIrq() {
+    s_handled++;
+}
+
+void onEdge(void* context) {
+    UNUSED(context);
+    s_handled++;
+}
+
+} // namespace
+
+/*============================================================================
+ * GPIO
+ *===========================================================================*/
+static void BM_GpioPinToggle(benchmark::State& state) {
+    sim::reset();
+    GPIO marker = Marker::toGpio();
+    marker.setMode(GPIO::Mode::Output);
+
+    for (auto _ : state) {
+        Marker::toggle();
+    }
+    benchmark::DoNotOptimize(Marker::isHigh());
+}
+BENCHMARK(BM_GpioPinToggle);
+
+static void BM_GpioToggle(benchmark::State& state) {
+    sim::reset();
+    GPIO led = GpioPin<PortId::A, 5>::toGpio();
+    led.setMode(GPIO::Mode::Output);
+
+    for (auto _ : state) {
+        led.toggle();
+    }
+    benchmark::DoNotOptimize(led.isHigh());
+}
+BENCHMARK(BM_GpioToggle);
+
+static void BM_GpioGroupWrite(benchmark::State& state) {
+    sim::reset();
+    GPIO::Group group = GpioPort<PortId::D>::group(0xF000);
+    u16 value = 0;
+
+    for (auto _ : state) {
+        group.write(value);
+        value = static_cast<u16>(value + 0x1000);
+    }
+    benchmark::DoNotOptimize(GpioPort<PortId::D>::readOutput());
+}
+BENCHMARK(BM_GpioGroupWrite);
+
+static void BM_GpioEdgeInterrupt(benchmark::State& state) {
+    sim::reset();
+    System::init();
+    GPIO button = GpioPin<PortId::C, 13>::toGpio();
+    button.setMode(GPIO::Mode::Input);
+    button.enableInterrupt(GPIO::Trigger::Both, onEdge);
+    sim::GpioRegisters* port = sim::gpioPort(static_cast<u32>(PortId::C));
+
+    bool level = false;
+    for (auto _ : state) {
+        level = !level;
+        sim::setInput(port, 13, level);
+    }
+    state.SetItemsProcessed(s_handled);
+}
+BENCHMARK(BM_GpioEdgeInterrupt);
+
+/**
+ * One LedBank step for a 40-LED panel on three ports, every pattern in
+ * use: cost per step is per port, not per LED.
+ */
+static void BM_LedBankStep(benchmark::State& state) {
+    sim::reset();
+    drivers::LedBank bank;
+    void* const ports[] = { GpioPort<PortId::A>::base(), GpioPort<PortId::D>::base(),
+                            GpioPort<PortId::E>::base() };
+    for (u8 i = 0; i < 40; i++) {
+        u8 led;
+        bank.add(ports[i % 3], static_cast<u8>(i / 3), drivers::LedBank::ActiveState::High, &led);
+        bank.setPattern(led, static_cast<drivers::LedBank::Pattern>(i % 6));
+    }
+
+    for (auto _ : state) {
+        bank.step();
+    }
+    benchmark::DoNotOptimize(GpioPort<PortId::D>::readOutput());
+}
+BENCHMARK(BM_LedBankStep);
+
+/*============================================================================
+ * CRC
+ *===========================================================================*/
+static void BM_Crc32(benchmark::State& state) {
+    static u8 buffer[1024];
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = static_cast<u8>(i * 31);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Crc::crc32(buffer, sizeof(buffer)));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * sizeof(buffer)));
+}
+BENCHMARK(BM_Crc32);
+
+static void BM_Crc16Modbus(benchmark::State& state) {
+    static u8 buffer[256];
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = static_cast<u8>(i * 31);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Crc::crc16(Crc::Crc16Type::Modbus, buffer, sizeof(buffer)));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * sizeof(buffer)));
+}
+BENCHMARK(BM_Crc16Modbus);
+
+/*============================================================================
+ * Critical Sections and Interrupts
+ *===========================================================================*/
+static void BM_CriticalSection(benchmark::State& state) {
+    sim::reset();
+    for (auto _ : state) {
+        CriticalSection cs;
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_CriticalSection);
+
+static void BM_CriticalSectionBasepri(benchmark::State& state) {
+    sim::reset();
+    for (auto _ : state) {
+        CriticalSection cs(IrqPriority::Medium);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_CriticalSectionBasepri);
+
+/**
+ * Interrupt raised inside a critical section: pended, then delivered
+ * when the section ends.
+ */
+static void BM_DeferredInterrupt(benchmark::State& state) {
+    sim::reset();
+    sim::setIrqHandler(IrqNumber::Tim7, onIrq);
+    System::setIrqPriority(IrqNumber::Tim7, IrqPriority::Medium);
+    System::enableIrq(IrqNumber::Tim7);
+
+    s_handled = 0;
+    for (auto _ : state) {
+        CriticalSection cs(IrqPriority::Medium);
+        System::setIrqPending(IrqNumber::Tim7);
+    }
+    if (s_handled != state.iterations()) {
+        state.SkipWithError("interrupt lost");
+    }
+}
+BENCHMARK(BM_DeferredInterrupt);
+
+/*============================================================================
+ * Profiler
+ *===========================================================================*/
+static void BM_ProfileScope(benchmark::State& state) {
+    sim::reset();
+    System::init();
+    Profiler::reset();
+    for (auto _ : state) {
+        Profiler::Scope scope(Profiler::Slot::Uart);
+        benchmark::ClobberMemory();
+    }
+
+    Profiler::Entry entry;
+    Profiler::read(static_cast<size_t>(Profiler::Slot::Uart), entry);
+    if (entry.calls != state.iterations()) {
+        state.SkipWithError("calls lost");
+    }
+}
+BENCHMARK(BM_ProfileScope);
@@ -0,0 +1,76 @@
+/**
+ * @file bench_log.cpp
+ * @brief Host benchmarks: deferred binary logging
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "log.hpp"
+#include "system.hpp"
+#include "hal/uart.hpp"
+#include "sim/sim.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace embedded;
+using namespace embedded::hal;
+
+namespace {
+
+u8 s_instance;                      ///< Stands in for a USART base address
+
+} // namespace
+
+static void BM_LogRecord(benchmark::State& state) {
+    sim::reset();
+    System::init();
+    UART uart(&s_instance);
+    UART::Config config;
+    config.txDma = true;
+    uart.init(config);
+    Log::init(&uart);
+
+    u32 value = 0;
+    for (auto _ : state) {
+        LOG_INFO("value %u of %u", value, 1000u);
+        value++;
+
+        // Drain before the queue fills so every record is encoded
+        if ((value % (LOG_BUFFER_RECORDS / 2)) == 0) {
+            state.PauseTiming();
+            Log::process();
+            sim::uartOutput(&s_instance).clear();
+            state.ResumeTiming();
+        }
+    }
+    Log::process();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogRecord);
+
+static void BM_LogProcess(benchmark::State& state) {
+    sim::reset();
+    System::init();
+    UART uart(&s_instance);
+    UART::Config config;
+    config.txDma = true;
+    uart.init(config);
+    Log::init(&uart);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (u32 i = 0; i < 8; i++) {
+            LOG_INFO("sample %u: %d", i, -static_cast<i32>(i));
+        }
+        state.ResumeTiming();
+
+        Log::process();
+
+        state.PauseTiming();
+        sim::uartOutput(&s_instance).clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * 8);
+}
+BENCHMARK(BM_LogProcess);
@@ -0,0 +1,149 @@
+/**
+ * @file bench_scheduler.cpp
+ * @brief Host benchmarks: cooperative scheduler
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "scheduler.hpp"
+#include "soft_timer.hpp"
+#include "system.hpp"
+#include "sim/sim.hpp"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace embedded;
+
+namespace {
+
+u32 s_runs;
+
+void countRun(void* context) {
+    UNUSED(context);
+    s_runs++;
+}
+
+void startSystem() {
+    sim::reset();
+    System::init();
+    Scheduler::init();
+    s_runs = 0;
+}
+
+} // namespace
+
+/**
+ * One simulated millisecond with N periodic tasks spread over the
+ * wheel: SysTick, expiry into the ready queue and dispatch.
+ */
+static void BM_SchedulerTick(benchmark::State& state) {
+    startSystem();
+    std::vector<Scheduler::Task> tasks(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < tasks.size(); i++) {
+        tasks[i].handler = countRun;
+        Scheduler::startPeriodic(&tasks[i], 1 + static_cast<u32>(i % 100));
+    }
+
+    for (auto _ : state) {
+        sim::advance(1);
+        while (Scheduler::dispatch()) {}
+    }
+    state.counters["runs/tick"] = benchmark::Counter(
+        static_cast<double>(s_runs) / static_cast<double>(state.iterations()));
+
+    for (Scheduler::Task& task : tasks) {
+        Scheduler::cancel(&task);
+    }
+}
+BENCHMARK(BM_SchedulerTick)->Arg(1)->Arg(16)->Arg(128)->Arg(1024);
+
+static void BM_SchedulerPostDispatch(benchmark::State& state) {
+    startSystem();
+    Scheduler::Task task;
+    task.handler = countRun;
+
+    for (auto _ : state) {
+        Scheduler::post(&task);
+        Scheduler::dispatch();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SchedulerPostDispatch);
+
+static void BM_SchedulerStartCancel(benchmark::State& state) {
+    startSystem();
+    Scheduler::Task task;
+    task.handler = countRun;
+
+    for (auto _ : state) {
+        Scheduler::startOnce(&task, 250);
+        Scheduler::cancel(&task);
+    }
+}
+BENCHMARK(BM_SchedulerStartCancel);
+
+namespace {
+
+Scheduler::Task s_periodic;
+
+void startPeriodicNow(void* context) {
+    UNUSED(context);
+    Scheduler::startPeriodic(&s_periodic, 10);
+}
+
+} // namespace
+
+/**
+ * A periodic task started from a handler, in the tick that was just
+ * dispatched: its first deadline is already behind the wheel, and it
+ * must still run once every period afterwards.
+ */
+static void BM_SchedulerStartFromHandler(benchmark::State& state) {
+    startSystem();
+    Scheduler::Task starter;
+    starter.handler = startPeriodicNow;
+    s_periodic.handler = countRun;
+
+    u32 ticks = 0;
+    for (auto _ : state) {
+        Scheduler::post(&starter);
+        while (Scheduler::dispatch()) {}
+        for (u32 i = 0; i < 100; i++) {
+            sim::advance(1);
+            while (Scheduler::dispatch()) {}
+        }
+        ticks += 100;
+        Scheduler::cancel(&s_periodic);
+    }
+
+    if (s_runs != (ticks / 10) + state.iterations()) {
+        state.SkipWithError("periodic task not re-armed");
+    }
+}
+BENCHMARK(BM_SchedulerStartFromHandler);
+
+/**
+ * One simulated millisecond with N periodic soft timers: the SysTick
+ * handler checks the list head and fires what expired.
+ */
+static void BM_SoftTimerTick(benchmark::State& state) {
+    startSystem();
+    std::vector<SoftTimer::Timer> timers(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < timers.size(); i++) {
+        timers[i].callback = countRun;
+        SoftTimer::startPeriodic(&timers[i], 1 + static_cast<u32>(i % 100));
+    }
+
+    for (auto _ : state) {
+        sim::advance(1);
+    }
+    state.counters["runs/tick"] = benchmark::Counter(
+        static_cast<double>(s_runs) / static_cast<double>(state.iterations()));
+
+    for (SoftTimer::Timer& timer : timers) {
+        SoftTimer::stop(&timer);
+    }
+}
+BENCHMARK(BM_SoftTimerTick)->Arg(1)->Arg(16)->Arg(128);
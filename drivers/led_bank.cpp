@@ -0,0 +1,216 @@
+/**
+ * @file led_bank.cpp
+ * @brief Batch driver for many pattern LEDs implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "drivers/led_bank.hpp"
+#include "hal/gpio.hpp"
+
+namespace embedded {
+namespace drivers {
+
+namespace {
+
+/**
+ * Pattern step table: bit n is the LED level during step n.
+ */
+struct PatternTable {
+    u64 steps;
+    u8  length;                         ///< Steps per cycle (1-64)
+    u8  stepDiv;                        ///< Bank steps per table step
+};
+
+// '#' lit, '.' dark, one character per stepMs
+constexpr PatternTable makePattern(const char* steps, u32 stepMs) {
+    const u8 stepDiv = static_cast<u8>((stepMs > LED_BANK_STEP_MS) ? stepMs / LED_BANK_STEP_MS : 1);
+    PatternTable table = { 0, 0, stepDiv };
+    while (steps[table.length] != '\0') {
+        if (steps[table.length] == '#') {
+            table.steps |= 1ULL << table.length;
+        }
+        table.length++;
+    }
+    return table;
+}
+
+// Indexed by slot: Off, then LedDriver::Pattern + 1
+constexpr PatternTable PATTERNS[] = {
+    makePattern(".",                                    1000),  // Off
+    makePattern("#",                                    1000),  // Solid
+    makePattern("#.",                                   500),   // Blink
+    makePattern("#.",                                   100),   // FastBlink
+    makePattern("#.",                                   1000),  // SlowBlink
+    makePattern("#.#.......",                           100),   // Heartbeat
+    makePattern("#.#.#...###.###.###...#.#.#.......",   100)    // SOS
+};
+
+constexpr bool tablesFit() {
+    for (const PatternTable& table : PATTERNS) {
+        if (table.length == 0 || table.length > 64) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(tablesFit(), "Pattern tables hold 1 to 64 steps");
+
+} // namespace
+
+LedBank::LedBank()
+    : m_slot()
+    , m_portIndex()
+    , m_pin()
+    , m_ports()
+    , m_pinMask()
+    , m_activeLow()
+    , m_slotMask()
+    , m_lit()
+    , m_output()
+    , m_count(0)
+    , m_portCount(0)
+    , m_step(0)
+    , m_timer() {
+    static_assert(sizeof(PATTERNS) / sizeof(PATTERNS[0]) == PATTERN_SLOTS,
+                  "One pattern table per slot");
+    static_assert(static_cast<u8>(Pattern::SOS) + 1 == PATTERN_SLOTS - 1,
+                  "Pattern table out of sync with LedDriver::Pattern");
+}
+
+LedBank::~LedBank() {
+    stop();
+}
+
+Status LedBank::add(void* port, u8 pin, ActiveState activeState, u8* index) {
+    if (port == nullptr || pin > 15) {
+        return Status::InvalidArg;
+    }
+
+    CriticalSection cs;
+    if (m_count >= LED_BANK_MAX_LEDS) {
+        return Status::NoMemory;
+    }
+
+    u8 p = 0;
+    while (p < m_portCount && m_ports[p] != port) {
+        p++;
+    }
+    if (p == m_portCount) {
+        if (m_portCount >= LED_BANK_MAX_PORTS) {
+            return Status::NoMemory;
+        }
+        m_ports[p] = port;
+        m_portCount++;
+    }
+
+    const u16 bit = static_cast<u16>(BIT(pin));
+    if (m_pinMask[p] & bit) {
+        return Status::InvalidArg;
+    }
+
+    // Start dark
+    if (activeState == ActiveState::Low) {
+        m_activeLow[p] |= bit;
+        m_output[p] |= bit;
+    } else {
+        m_output[p] &= static_cast<u16>(~bit);
+    }
+    hal::GPIO::Group(port, bit).write(m_output[p]);
+
+    m_pinMask[p] |= bit;
+    m_slotMask[p][SLOT_OFF] |= bit;
+
+    const u8 led = m_count++;
+    m_slot[led] = SLOT_OFF;
+    m_portIndex[led] = p;
+    m_pin[led] = pin;
+
+    if (index != nullptr) {
+        *index = led;
+    }
+
+    return Status::Ok;
+}
+
+void LedBank::setPattern(u8 led, Pattern pattern) {
+    setSlot(led, static_cast<u8>(static_cast<u8>(pattern) + 1));
+}
+
+void LedBank::on(u8 led) {
+    setPattern(led, Pattern::Solid);
+}
+
+void LedBank::off(u8 led) {
+    setSlot(led, SLOT_OFF);
+}
+
+bool LedBank::isOn(u8 led) const {
+    if (led >= m_count) {
+        return false;
+    }
+    return (m_lit[m_portIndex[led]] & BIT(m_pin[led])) != 0;
+}
+
+Status LedBank::start() {
+    m_timer.callback = onStep;
+    m_timer.context = this;
+    return SoftTimer::startPeriodic(&m_timer, LED_BANK_STEP_MS);
+}
+
+void LedBank::stop() {
+    SoftTimer::stop(&m_timer);
+}
+
+void LedBank::step() {
+    // Evaluate each pattern once; LEDs sharing a pattern share its phase
+    u8 litSlots = 0;
+    for (u8 s = 0; s < PATTERN_SLOTS; s++) {
+        const PatternTable& table = PATTERNS[s];
+        u32 position = (m_step / table.stepDiv) % table.length;
+        if ((table.steps >> position) & 1) {
+            litSlots = static_cast<u8>(litSlots | BIT(s));
+        }
+    }
+    m_step++;
+
+    for (u8 p = 0; p < m_portCount; p++) {
+        u16 lit = 0;
+        for (u8 s = 0; s < PATTERN_SLOTS; s++) {
+            if (litSlots & BIT(s)) {
+                lit = static_cast<u16>(lit | m_slotMask[p][s]);
+            }
+        }
+        m_lit[p] = lit;
+
+        // One BSRR store per port, and only when a pin changes
+        u16 output = static_cast<u16>((lit ^ m_activeLow[p]) & m_pinMask[p]);
+        if (output != m_output[p]) {
+            hal::GPIO::Group(m_ports[p], m_pinMask[p]).write(output);
+            m_output[p] = output;
+        }
+    }
+}
+
+void LedBank::setSlot(u8 led, u8 slot) {
+    if (led >= m_count || slot >= PATTERN_SLOTS) {
+        return;
+    }
+
+    const u8 p = m_portIndex[led];
+    const u16 bit = static_cast<u16>(BIT(m_pin[led]));
+
+    CriticalSection cs;
+    m_slotMask[p][m_slot[led]] &= static_cast<u16>(~bit);
+    m_slotMask[p][slot] |= bit;
+    m_slot[led] = slot;
+}
+
+void LedBank::onStep(void* context) {
+    static_cast<LedBank*>(context)->step();
+}
+
+} // namespace drivers
+} // namespace embedded
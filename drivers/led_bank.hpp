@@ -0,0 +1,154 @@
+/**
+ * @file led_bank.hpp
+ * @brief Batch driver for many pattern LEDs
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef DRIVERS_LED_BANK_HPP
+#define DRIVERS_LED_BANK_HPP
+
+#include "types.hpp"
+#include "config.hpp"
+#include "soft_timer.hpp"
+#include "drivers/led_driver.hpp"
+
+namespace embedded {
+namespace drivers {
+
+/**
+ * @class LedBank
+ * @brief Drives up to LED_BANK_MAX_LEDS pattern LEDs from one timer
+ *
+ * Patterns are step tables in flash at LED_BANK_STEP_MS resolution. All
+ * LEDs share one step counter, so LEDs showing the same pattern are in
+ * phase. LED state is kept as arrays (struct of arrays) plus, per port,
+ * one pin mask per pattern: a step evaluates each pattern once, ORs the
+ * masks of the patterns that are lit and writes every port that changed
+ * with a single BSRR store. The cost per step depends on the number of
+ * ports, not LEDs.
+ *
+ * start() runs step() from a periodic SoftTimer (SysTick context).
+ * setPattern(), on() and off() are safe from any context and take
+ * effect at the next step.
+ */
+class LedBank {
+public:
+    using Pattern = LedDriver::Pattern;
+    using ActiveState = LedDriver::ActiveState;
+
+    /**
+     * @brief Constructor
+     */
+    LedBank();
+
+    /**
+     * @brief Destructor (stops the step timer)
+     */
+    ~LedBank();
+
+    /**
+     * @brief Add an LED
+     *
+     * The pin must already be configured as an output. A new LED starts
+     * off. LEDs are numbered in the order they are added.
+     *
+     * @param port GPIO port base address (GpioPort<...>::base())
+     * @param pin Pin number (0-15)
+     * @param activeState Active state configuration
+     * @param index Receives the LED index (may be nullptr)
+     * @return Status::Ok, Status::InvalidArg for a bad pin or a pin
+     *         already in the bank, Status::NoMemory if the bank or its
+     *         port table is full
+     */
+    Status add(void* port, u8 pin, ActiveState activeState = ActiveState::High,
+               u8* index = nullptr);
+
+    /**
+     * @brief Set an LED's pattern
+     *
+     * The LED joins the pattern's shared phase.
+     *
+     * @param led LED index
+     * @param pattern Pattern to show
+     */
+    void setPattern(u8 led, Pattern pattern);
+
+    /**
+     * @brief Turn an LED steadily on (Pattern::Solid)
+     * @param led LED index
+     */
+    void on(u8 led);
+
+    /**
+     * @brief Turn an LED off
+     * @param led LED index
+     */
+    void off(u8 led);
+
+    /**
+     * @brief Check whether an LED was lit by the last step
+     * @param led LED index
+     * @return true if lit
+     */
+    bool isOn(u8 led) const;
+
+    /**
+     * @brief Get number of LEDs in the bank
+     * @return LED count
+     */
+    u8 getCount() const { return m_count; }
+
+    /**
+     * @brief Step the bank from a periodic SoftTimer
+     * @return Status::Ok, or Status::Busy if already started
+     */
+    Status start();
+
+    /**
+     * @brief Stop stepping; LEDs keep their current level
+     */
+    void stop();
+
+    /**
+     * @brief Advance all LEDs by one LED_BANK_STEP_MS step
+     *
+     * Called by the step timer; call directly only when not started.
+     */
+    void step();
+
+private:
+    static constexpr u8 PATTERN_SLOTS = 7;  ///< Off + the six LedDriver patterns
+    static constexpr u8 SLOT_OFF = 0;
+
+    // Per LED (struct of arrays)
+    u8          m_slot[LED_BANK_MAX_LEDS];      ///< Pattern slot (SLOT_OFF or pattern + 1)
+    u8          m_portIndex[LED_BANK_MAX_LEDS];
+    u8          m_pin[LED_BANK_MAX_LEDS];
+
+    // Per port
+    void*       m_ports[LED_BANK_MAX_PORTS];
+    u16         m_pinMask[LED_BANK_MAX_PORTS];  ///< Pins owned by the bank
+    u16         m_activeLow[LED_BANK_MAX_PORTS];
+    u16         m_slotMask[LED_BANK_MAX_PORTS][PATTERN_SLOTS];
+    u16         m_lit[LED_BANK_MAX_PORTS];      ///< LEDs lit by the last step
+    u16         m_output[LED_BANK_MAX_PORTS];   ///< Last pin levels written
+
+    u8          m_count;
+    u8          m_portCount;
+    u32         m_step;
+    SoftTimer::Timer m_timer;
+
+    void setSlot(u8 led, u8 slot);
+
+    /**
+     * @brief Step timer callback (SysTick context)
+     */
+    static void onStep(void* context);
+};
+
+} // namespace drivers
+} // namespace embedded
+
+#endif // DRIVERS_LED_BANK_HPP
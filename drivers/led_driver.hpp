@@ -11,6 +11,8 @@
 
 #include "types.hpp"
 #include "hal/gpio.hpp"
+#include "hal/timer.hpp"
+#include "soft_timer.hpp"
 
 namespace embedded {
 namespace drivers {
@@ -23,6 +25,14 @@ namespace drivers {
  * - On/Off control
  * - Blinking patterns
  * - PWM dimming (requires timer)
+ * 
+ * With the GPIO backend, patterns are stepped by a one-shot SoftTimer
+ * armed for the end of each on/off phase, so nothing has to be polled
+ * and the LED costs no CPU between edges.
+ * 
+ * With the PWM backend the LED pin is driven by a timer channel:
+ * brightness is the compare value and patterns are compare tables
+ * streamed by the timer's DMA burst.
  */
 class LedDriver {
 public:
@@ -53,6 +63,19 @@ public:
      */
     LedDriver(hal::GPIO* gpio, ActiveState activeState = ActiveState::High);
 
+    /**
+     * @brief Constructor for the hardware PWM backend
+     * 
+     * The timer must be initialized (period sets the PWM resolution) and
+     * the LED pin set to the channel's alternate function.
+     * 
+     * @param pwm Pointer to initialized timer
+     * @param channel Timer channel driving the LED
+     * @param activeState Active state configuration
+     */
+    LedDriver(hal::Timer* pwm, hal::Timer::Channel channel,
+              ActiveState activeState = ActiveState::High);
+
     /**
      * @brief Destructor
      */
@@ -79,8 +102,27 @@ public:
      */
     bool isOn() const;
 
+    /**
+     * @brief Set brightness
+     * 
+     * PWM backend only; the GPIO backend treats any non-zero value as on.
+     * 
+     * @param percent Brightness (0-100)
+     */
+    void setBrightness(u8 percent);
+
+    /**
+     * @brief Get brightness
+     * @return Brightness (0-100)
+     */
+    u8 getBrightness() const;
+
     /**
      * @brief Set blink pattern
+     * 
+     * With the PWM backend the pattern is played from a flash compare
+     * table by timer DMA burst, at the current brightness.
+     * 
      * @param pattern Blink pattern to use
      */
     void setPattern(Pattern pattern);
@@ -98,16 +140,6 @@ public:
      */
     void setBlinkTiming(u16 onTime, u16 offTime);
 
-    /**
-     * @brief Update LED state (call periodically)
-     * 
-     * This function should be called periodically (e.g., every 10ms)
-     * to update blink patterns and effects.
-     * 
-     * @param elapsedMs Milliseconds since last update
-     */
-    void update(u32 elapsedMs);
-
     /**
      * @brief Blink LED a specific number of times
      * @param count Number of blinks
@@ -117,12 +149,15 @@ public:
     void blinkCount(u8 count, u16 onTime = 200, u16 offTime = 200);
 
 private:
-    hal::GPIO*  m_gpio;
+    hal::GPIO*  m_gpio;             ///< GPIO backend (nullptr with PWM)
+    hal::Timer* m_pwm;              ///< PWM backend (nullptr with GPIO)
+    hal::Timer::Channel m_pwmChannel;
+    u8          m_brightness;
     ActiveState m_activeState;
     Pattern     m_pattern;
     bool        m_isOn;
     
-    u32         m_timer;
+    SoftTimer::Timer m_phaseTimer;  ///< Ends the current on/off phase
     u16         m_onTime;
     u16         m_offTime;
     
@@ -131,7 +166,16 @@ private:
     u8          m_patternStep;
     
     void setPhysicalState(bool on);
-    void updatePattern(u32 elapsedMs);
+    void startPwmPattern();
+
+    /**
+     * @brief Phase timer callback (SysTick context)
+     * 
+     * Applies the next pattern step and re-arms the timer for its
+     * duration; Solid and finished blinkCount() sequences leave it
+     * stopped.
+     */
+    static void onPhaseTimer(void* context);
 };
 
 } // namespace drivers
@@ -0,0 +1,225 @@
+/**
+ * @file adc.hpp
+ * @brief ADC Hardware Abstraction Layer
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef HAL_ADC_HPP
+#define HAL_ADC_HPP
+
+#include "types.hpp"
+#include "dma.hpp"
+
+namespace embedded {
+namespace hal {
+
+/**
+ * @class ADC
+ * @brief Analog-to-digital converter abstraction
+ *
+ * Supports single blocking conversions and continuous sampling of a
+ * regular-group scan sequence. In continuous mode a timer TRGO event
+ * starts each scan and a circular DMA stream fills a caller-provided
+ * double buffer; the block callback runs for each completed half, so
+ * one half can be processed while the other fills, with no per-sample
+ * interrupt.
+ */
+class ADC {
+public:
+    /**
+     * @brief Conversion resolution
+     */
+    enum class Resolution : u8 {
+        Bits12 = 0,
+        Bits10 = 1,
+        Bits8  = 2,
+        Bits6  = 3
+    };
+
+    /**
+     * @brief Channel sample time (ADC clock cycles)
+     */
+    enum class SampleTime : u8 {
+        Cycles3   = 0,
+        Cycles15  = 1,
+        Cycles28  = 2,
+        Cycles56  = 3,
+        Cycles84  = 4,
+        Cycles112 = 5,
+        Cycles144 = 6,
+        Cycles480 = 7
+    };
+
+    /**
+     * @brief Regular group trigger source
+     */
+    enum class Trigger : u8 {
+        Software    = 0xFF,     ///< start() per scan (or continuous)
+        Tim1Cc1     = 0x00,
+        Tim1Cc2     = 0x01,
+        Tim1Cc3     = 0x02,
+        Tim2Cc2     = 0x03,
+        Tim2Cc3     = 0x04,
+        Tim2Cc4     = 0x05,
+        Tim2Trgo    = 0x06,
+        Tim3Cc1     = 0x07,
+        Tim3Trgo    = 0x08,
+        Tim4Cc4     = 0x09,
+        Tim5Cc1     = 0x0A,
+        Tim5Cc2     = 0x0B,
+        Tim5Cc3     = 0x0C,
+        Tim8Cc1     = 0x0D,
+        Tim8Trgo    = 0x0E,
+        Exti11      = 0x0F
+    };
+
+    /**
+     * @brief Trigger edge
+     */
+    enum class TriggerEdge : u8 {
+        Rising  = 1,
+        Falling = 2,
+        Both    = 3
+    };
+
+    /**
+     * @brief Maximum channels in a scan sequence
+     */
+    static constexpr size_t MAX_SEQUENCE = 16;
+
+    /**
+     * @brief ADC configuration structure
+     */
+    struct Config {
+        Resolution  resolution  = Resolution::Bits12;
+        SampleTime  sampleTime  = SampleTime::Cycles84;    ///< Applied to every sequence channel
+        Trigger     trigger     = Trigger::Software;
+        TriggerEdge triggerEdge = TriggerEdge::Rising;
+        u8          prescaler   = 4;            ///< ADC clock = APB2 / 2, 4, 6 or 8
+        IrqPriority irqPriority = IrqPriority::Medium;  ///< ADC and DMA stream interrupts
+    };
+
+    /**
+     * @brief Callback for a completed buffer half
+     * @param samples Interleaved samples (sequence order), valid until
+     *        the DMA wraps back to this half
+     * @param scans Number of complete scans in the block
+     * @param context User context
+     */
+    using BlockCallback = void (*)(const u16* samples, size_t scans, void* context);
+
+    /**
+     * @brief Constructor
+     * @param instance ADC peripheral instance
+     */
+    explicit ADC(void* instance);
+
+    /**
+     * @brief Destructor
+     */
+    ~ADC();
+
+    /**
+     * @brief Initialize ADC with configuration
+     * @param config ADC configuration
+     * @return Status::Ok on success
+     */
+    Status init(const Config& config);
+
+    /**
+     * @brief Deinitialize ADC
+     * @return Status::Ok on success
+     */
+    Status deinit();
+
+    /**
+     * @brief Set the regular-group scan sequence
+     * @param channels Channel numbers (0-18) in conversion order
+     * @param count Number of channels (1-16)
+     * @return Status::Ok on success, Status::Busy while sampling
+     */
+    Status setSequence(const u8* channels, size_t count);
+
+    /**
+     * @brief Perform one blocking conversion
+     * @param channel Channel number (0-18)
+     * @param value Pointer to store the result
+     * @param timeoutMs Timeout in milliseconds
+     * @return Status::Ok on success, Status::Busy while sampling
+     */
+    Status read(u8 channel, u16* value, u32 timeoutMs = 10);
+
+    /**
+     * @brief Start continuous sampling into a double buffer
+     *
+     * @p buffer holds two halves of @p scansPerHalf scans each, i.e.
+     * 2 * scansPerHalf * sequence length samples. The DMA stream runs in
+     * circular mode, raising the callback at half and full transfer.
+     * Use a timer trigger for a fixed sample rate.
+     *
+     * @param buffer Sample buffer in DMA-accessible SRAM (not CCM)
+     * @param scansPerHalf Scans per buffer half
+     * @param callback Block callback, run in DMA interrupt context
+     * @param context User context passed to callback
+     * @return Status::Ok on success, Status::InvalidArg without a
+     *         sequence, Status::Busy if already sampling
+     */
+    Status startContinuous(u16* buffer, size_t scansPerHalf,
+                           BlockCallback callback, void* context = nullptr);
+
+    /**
+     * @brief Stop continuous sampling
+     */
+    void stop();
+
+    /**
+     * @brief Check whether continuous sampling is running
+     * @return true while sampling
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Get samples lost to DMA overrun
+     *
+     * On overrun sampling is restarted at the start of the buffer.
+     *
+     * @return Overrun count since init()
+     */
+    u32 getOverruns() const;
+
+    /**
+     * @brief ADC interrupt handler (overrun)
+     */
+    void handleInterrupt();
+
+private:
+    void*   m_instance;
+    Config  m_config;
+
+    u8      m_sequence[MAX_SEQUENCE];
+    u8      m_sequenceLength;
+
+    Dma*    m_dma;                  ///< DMA stream
+    u16*    m_buffer;
+    size_t  m_scansPerHalf;
+    BlockCallback m_callback;
+    void*   m_callbackContext;
+    volatile bool m_running;
+    u32     m_overruns;
+
+    void enableClock();
+    Status configureDma();
+    void applySequence();
+
+    /**
+     * @brief DMA half/full transfer callback
+     */
+    static void onDma(u32 events, void* context);
+};
+
+} // namespace hal
+} // namespace embedded
+
+#endif // HAL_ADC_HPP
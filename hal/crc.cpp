@@ -0,0 +1,194 @@
+/**
+ * @file crc.cpp
+ * @brief CRC unit implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "hal/crc.hpp"
+#include "hal/dma.hpp"
+#include "system.hpp"
+
+#include <cstring>
+
+namespace embedded {
+namespace hal {
+
+namespace {
+
+volatile u32* const CRC_DR      = reinterpret_cast<volatile u32*>(0x40023000);
+volatile u32* const CRC_CR      = reinterpret_cast<volatile u32*>(0x40023008);
+volatile u32* const RCC_AHB1ENR = reinterpret_cast<volatile u32*>(0x40023830);
+
+constexpr u32 CR_RESET          = BIT(0);
+constexpr u32 RCC_AHB1ENR_CRCEN = BIT(12);
+
+constexpr u32 CRC32_POLY        = 0x04C11DB7;
+constexpr size_t DMA_MAX_ITEMS  = 0xFFFF;
+
+bool            s_ready;                ///< Clocked by init()
+volatile bool   s_owned;                ///< A call or DMA feed holds the unit
+Dma*            s_dma;
+const u32*      s_dmaNext;
+size_t          s_dmaRemaining;
+Crc::Callback   s_callback;
+void*           s_context;
+
+bool acquire() {
+    CriticalSection cs;
+    if (!s_ready || s_owned) {
+        return false;
+    }
+    s_owned = true;
+    return true;
+}
+
+void release() {
+    s_owned = false;
+}
+
+/**
+ * Load a running value. DR can only be reset to CRC32_INIT, so write
+ * the word that the unit maps from CRC32_INIT to crc: run the 32 bit
+ * steps backwards (the polynomial is odd, so each step is invertible).
+ */
+void seed(u32 crc) {
+    *CRC_CR = CR_RESET;
+    if (crc == Crc::CRC32_INIT) {
+        return;
+    }
+    for (u32 bit = 0; bit < 32; bit++) {
+        crc = (crc & 1) ? ((crc ^ CRC32_POLY) >> 1) | 0x80000000 : (crc >> 1);
+    }
+    *CRC_DR = crc ^ Crc::CRC32_INIT;
+}
+
+void startDmaChunk() {
+    size_t chunk = (s_dmaRemaining > DMA_MAX_ITEMS) ? DMA_MAX_ITEMS : s_dmaRemaining;
+    s_dma->start(s_dmaNext, const_cast<u32*>(CRC_DR), chunk);
+    s_dmaNext += chunk;
+    s_dmaRemaining -= chunk;
+}
+
+void finishDma(Status status) {
+    u32 crc = *CRC_DR;
+    Dma::release(s_dma);
+    s_dma = nullptr;
+    release();
+    s_callback(status, crc, s_context);
+}
+
+void onDma(u32 events, void* context) {
+    UNUSED(context);
+    if (events & Dma::EVENT_ERROR) {
+        finishDma(Status::Error);
+    } else if (events & Dma::EVENT_COMPLETE) {
+        if (s_dmaRemaining != 0) {
+            startDmaChunk();
+        } else {
+            finishDma(Status::Ok);
+        }
+    }
+}
+
+} // namespace
+
+Status Crc::init() {
+    CriticalSection cs;
+    *RCC_AHB1ENR |= RCC_AHB1ENR_CRCEN;
+    DSB();
+    s_ready = true;
+    return Status::Ok;
+}
+
+u32 Crc::crc32(const void* data, size_t length, u32 crc) {
+    if (length < 4 || !acquire()) {
+        return crc32Soft(data, length, crc);
+    }
+
+    seed(crc);
+    const u8* bytes = static_cast<const u8*>(data);
+    for (; length >= 4; length -= 4, bytes += 4) {
+        // Unaligned LDR is fine on the M4; REV puts the first byte on top
+        u32 word;
+        std::memcpy(&word, bytes, sizeof(word));
+        *CRC_DR = __builtin_bswap32(word);
+    }
+    crc = *CRC_DR;
+    release();
+
+    for (; length > 0; length--) {
+        crc = softByte(crc, *bytes++);
+    }
+    return crc;
+}
+
+u32 Crc::crc32Words(const u32* words, size_t count, u32 crc) {
+    if (count == 0 || !acquire()) {
+        return crc32WordsSoft(words, count, crc);
+    }
+
+    seed(crc);
+    for (size_t i = 0; i < count; i++) {
+        *CRC_DR = words[i];
+    }
+    crc = *CRC_DR;
+    release();
+
+    return crc;
+}
+
+Status Crc::crc32WordsDma(const u32* words, size_t count, Callback callback,
+                          void* context, u32 crc) {
+    if (words == nullptr || callback == nullptr) {
+        return Status::InvalidArg;
+    }
+
+    if (count < CRC_DMA_THRESHOLD || !s_ready) {
+        callback(Status::Ok, crc32Words(words, count, crc), context);
+        return Status::Ok;
+    }
+
+    if (!acquire()) {
+        return Status::Busy;
+    }
+
+    Status status = Dma::allocate(DmaRequest::Memory, s_dma);
+    if (status == Status::Ok) {
+        // PAR is the source in memory-to-memory mode: increment it, not DR
+        Dma::Config config;
+        config.direction = Dma::Direction::MemoryToMemory;
+        config.peripheralWidth = Dma::Width::Word;
+        config.memoryWidth = Dma::Width::Word;
+        config.peripheralIncrement = true;
+        config.memoryIncrement = false;
+        config.priority = Dma::Priority::Low;
+        status = s_dma->configure(config, onDma);
+        if (status != Status::Ok) {
+            Dma::release(s_dma);
+        }
+    }
+    if (status != Status::Ok) {
+        s_dma = nullptr;
+        release();
+        return status;
+    }
+
+    s_callback = callback;
+    s_context = context;
+    s_dmaNext = words;
+    s_dmaRemaining = count;
+
+    seed(crc);
+    startDmaChunk();
+
+    return Status::Ok;
+}
+
+bool Crc::isBusy() {
+    return s_dma != nullptr;
+}
+
+} // namespace hal
+} // namespace embedded
@@ -0,0 +1,198 @@
+/**
+ * @file crc.hpp
+ * @brief CRC unit Hardware Abstraction Layer and software CRC variants
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef HAL_CRC_HPP
+#define HAL_CRC_HPP
+
+#include "types.hpp"
+#include "config.hpp"
+
+namespace embedded {
+namespace hal {
+
+/**
+ * @class Crc
+ * @brief Hardware CRC32 with software fallback, plus CRC16/CRC8 tables
+ *
+ * The STM32F4 CRC unit computes CRC-32/MPEG-2 (polynomial 0x04C11DB7,
+ * initial value 0xFFFFFFFF, MSB first, no reflection, no final XOR)
+ * over one 32-bit word per AHB write. Two orderings are exposed:
+ *
+ *   crc32()       Byte stream in address order, i.e. plain CRC-32/MPEG-2.
+ *                 Words are byte-reversed (REV) on the way in and a tail
+ *                 of 1-3 bytes is finished in software.
+ *   crc32Words()  Native little-endian words, the STM32 convention for
+ *                 flash images and records. This is the only ordering
+ *                 the DMA can feed (crc32WordsDma()).
+ *
+ * Every function takes the running value, so a buffer may be processed
+ * in pieces: crc32(b, n2, crc32(a, n1)) == crc32(a + b) for any split.
+ * The unit has no initial-value register; a running value is loaded by
+ * writing the one word that takes the reset value to it.
+ *
+ * The unit is shared. A call that finds it in use (a DMA feed, or a
+ * preempted call from another context) or not yet clocked by init()
+ * computes the same result with the slice-by-4 software tables, so all
+ * functions except crc32WordsDma() are safe from any context.
+ *
+ * CRC16 and CRC8 variants are software only (slice-by-4 tables in
+ * flash). None of the offered variants has a final XOR, so their
+ * running value is the result as well.
+ */
+class Crc {
+public:
+    static constexpr u32 CRC32_INIT = 0xFFFFFFFF;  ///< CRC-32/MPEG-2 initial value
+
+    /**
+     * @brief CRC16 variants
+     */
+    enum class Crc16Type : u8 {
+        CcittFalse  = 0,    ///< Poly 0x1021, init 0xFFFF, MSB first
+        Xmodem      = 1,    ///< Poly 0x1021, init 0x0000, MSB first
+        Modbus      = 2     ///< Poly 0x8005, init 0xFFFF, reflected
+    };
+
+    /**
+     * @brief CRC8 variants
+     */
+    enum class Crc8Type : u8 {
+        Smbus       = 0,    ///< Poly 0x07, init 0x00, MSB first
+        Maxim       = 1     ///< Poly 0x31, init 0x00, reflected (1-Wire)
+    };
+
+    /**
+     * @brief Completion callback for crc32WordsDma()
+     * @param status Status::Ok, or Status::Error on a DMA transfer error
+     * @param crc Running CRC over the buffer
+     * @param context User context
+     */
+    using Callback = void (*)(Status status, u32 crc, void* context);
+
+    /**
+     * @brief Clock the CRC unit
+     *
+     * Until init() all CRC32 functions use the software tables.
+     *
+     * @return Status::Ok on success
+     */
+    static Status init();
+
+    /**
+     * @brief CRC-32/MPEG-2 over a byte stream
+     * @param data Bytes (any alignment)
+     * @param length Number of bytes
+     * @param crc Running value (CRC32_INIT to start)
+     * @return Running value after the bytes
+     */
+    static u32 crc32(const void* data, size_t length, u32 crc = CRC32_INIT);
+
+    /**
+     * @brief CRC32 over native 32-bit words
+     * @param words Word-aligned buffer
+     * @param count Number of words
+     * @param crc Running value (CRC32_INIT to start)
+     * @return Running value after the words
+     */
+    static u32 crc32Words(const u32* words, size_t count, u32 crc = CRC32_INIT);
+
+    /**
+     * @brief Feed native 32-bit words to the CRC unit by DMA
+     *
+     * Claims the unit and a memory-to-memory DMA2 stream
+     * (DmaRequest::Memory) for the transfer and releases both before
+     * the callback runs, in DMA interrupt context. Buffers below
+     * CRC_DMA_THRESHOLD words are not worth the setup: they are
+     * computed by the CPU and the callback runs before this returns.
+     * The buffer must not be in CCM and must stay unchanged until the
+     * callback.
+     *
+     * @param words Word-aligned buffer
+     * @param count Number of words
+     * @param callback Completion callback
+     * @param context User context passed to callback
+     * @param crc Running value (CRC32_INIT to start)
+     * @return Status::Ok if the callback has run or will run,
+     *         Status::InvalidArg for a null buffer or callback,
+     *         Status::Busy if the unit or the DMA stream is in use
+     */
+    static Status crc32WordsDma(const u32* words, size_t count, Callback callback,
+                                void* context = nullptr, u32 crc = CRC32_INIT);
+
+    /**
+     * @brief Check whether a DMA feed is running
+     * @return true until the crc32WordsDma() callback
+     */
+    static bool isBusy();
+
+    /**
+     * @brief Software crc32() (same result, no hardware access)
+     */
+    static u32 crc32Soft(const void* data, size_t length, u32 crc = CRC32_INIT);
+
+    /**
+     * @brief Software crc32Words() (same result, no hardware access)
+     */
+    static u32 crc32WordsSoft(const u32* words, size_t count, u32 crc = CRC32_INIT);
+
+    /**
+     * @brief Get the initial value of a CRC16 variant
+     * @param type CRC16 variant
+     * @return Value to start a running CRC with
+     */
+    static u16 crc16Init(Crc16Type type);
+
+    /**
+     * @brief CRC16 over a byte stream
+     * @param type CRC16 variant
+     * @param data Bytes (any alignment)
+     * @param length Number of bytes
+     * @return CRC of the bytes
+     */
+    static u16 crc16(Crc16Type type, const void* data, size_t length) {
+        return crc16(type, data, length, crc16Init(type));
+    }
+
+    /**
+     * @brief Continue a CRC16
+     * @param type CRC16 variant
+     * @param data Bytes (any alignment)
+     * @param length Number of bytes
+     * @param crc Running value (crc16Init() to start)
+     * @return Running value after the bytes
+     */
+    static u16 crc16(Crc16Type type, const void* data, size_t length, u16 crc);
+
+    /**
+     * @brief CRC8 over a byte stream
+     *
+     * All CRC8 variants start from 0.
+     *
+     * @param type CRC8 variant
+     * @param data Bytes (any alignment)
+     * @param length Number of bytes
+     * @param crc Running value (0 to start)
+     * @return Running value after the bytes
+     */
+    static u8 crc8(Crc8Type type, const void* data, size_t length, u8 crc = 0);
+
+private:
+    /**
+     * @brief Advance a CRC32 over one MSB-first word with the tables
+     */
+    static u32 softWord(u32 crc, u32 word);
+
+    /**
+     * @brief Advance a CRC32 over one byte with the tables
+     */
+    static u32 softByte(u32 crc, u8 byte);
+};
+
+} // namespace hal
+} // namespace embedded
+
+#endif // HAL_CRC_HPP
@@ -0,0 +1,165 @@
+/**
+ * @file crc_table.cpp
+ * @brief Slice-by-4 software CRC implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ *
+ * Shared by the target (fallback while the CRC unit is busy) and the
+ * host build. Tables are generated at compile time and live in flash.
+ */
+
+#include "hal/crc.hpp"
+
+namespace embedded {
+namespace hal {
+
+namespace {
+
+/**
+ * Slice-by-4 tables: entry [k][i] is the CRC contribution of byte i
+ * followed by k zero bytes, so four bytes are folded per lookup round.
+ */
+template <typename T>
+struct SliceTables {
+    T entries[4][256];
+};
+
+template <typename T>
+constexpr SliceTables<T> makeTables(T poly, bool reflected) {
+    constexpr u32 BITS = sizeof(T) * 8;
+    constexpr u32 MASK = static_cast<u32>(static_cast<T>(~0u));
+    constexpr u32 TOP = 1UL << (BITS - 1);
+
+    SliceTables<T> tables = {};
+    for (u32 i = 0; i < 256; i++) {
+        u32 crc = reflected ? i : (i << (BITS - 8));
+        for (u32 bit = 0; bit < 8; bit++) {
+            if (reflected) {
+                crc = (crc & 1) ? (crc >> 1) ^ poly : (crc >> 1);
+            } else {
+                crc = (crc & TOP) ? ((crc << 1) ^ poly) & MASK : (crc << 1) & MASK;
+            }
+        }
+        tables.entries[0][i] = static_cast<T>(crc);
+    }
+
+    for (u32 k = 1; k < 4; k++) {
+        for (u32 i = 0; i < 256; i++) {
+            u32 prev = tables.entries[k - 1][i];
+            u32 crc = reflected ? (prev >> 8) ^ tables.entries[0][prev & 0xFF]
+                                : ((prev << 8) & MASK) ^ tables.entries[0][prev >> (BITS - 8)];
+            tables.entries[k][i] = static_cast<T>(crc);
+        }
+    }
+    return tables;
+}
+
+constexpr SliceTables<u32> CRC32_TABLES   = makeTables<u32>(0x04C11DB7, false);
+constexpr SliceTables<u16> CRC16_TABLES[] = {
+    makeTables<u16>(0x1021, false),     // CCITT-FALSE, XMODEM
+    makeTables<u16>(0xA001, true)       // MODBUS (0x8005 reflected)
+};
+constexpr SliceTables<u8>  CRC8_TABLES[]  = {
+    makeTables<u8>(0x07, false),        // SMBUS
+    makeTables<u8>(0x8C, true)          // MAXIM (0x31 reflected)
+};
+
+struct Crc16Params {
+    u8  table;
+    bool reflected;
+    u16 init;
+};
+
+// Indexed by Crc::Crc16Type
+constexpr Crc16Params CRC16_PARAMS[] = {
+    { 0, false, 0xFFFF },
+    { 0, false, 0x0000 },
+    { 1, true,  0xFFFF }
+};
+
+static_assert(CRC32_TABLES.entries[0][1] == 0x04C11DB7, "CRC32 table generation");
+static_assert(CRC16_TABLES[1].entries[0][1] == 0xC0C1, "CRC16 reflected table generation");
+
+inline u32 loadBigEndian(const u8* bytes) {
+    return (static_cast<u32>(bytes[0]) << 24) | (static_cast<u32>(bytes[1]) << 16) |
+           (static_cast<u32>(bytes[2]) << 8) | bytes[3];
+}
+
+} // namespace
+
+u32 Crc::softWord(u32 crc, u32 word) {
+    const u32 (&t)[4][256] = CRC32_TABLES.entries;
+    crc ^= word;
+    return t[3][crc >> 24] ^ t[2][(crc >> 16) & 0xFF] ^ t[1][(crc >> 8) & 0xFF] ^ t[0][crc & 0xFF];
+}
+
+u32 Crc::softByte(u32 crc, u8 byte) {
+    return (crc << 8) ^ CRC32_TABLES.entries[0][(crc >> 24) ^ byte];
+}
+
+u32 Crc::crc32Soft(const void* data, size_t length, u32 crc) {
+    const u8* bytes = static_cast<const u8*>(data);
+    for (; length >= 4; length -= 4, bytes += 4) {
+        crc = softWord(crc, loadBigEndian(bytes));
+    }
+    for (; length > 0; length--) {
+        crc = softByte(crc, *bytes++);
+    }
+    return crc;
+}
+
+u32 Crc::crc32WordsSoft(const u32* words, size_t count, u32 crc) {
+    for (size_t i = 0; i < count; i++) {
+        crc = softWord(crc, words[i]);
+    }
+    return crc;
+}
+
+u16 Crc::crc16Init(Crc16Type type) {
+    return CRC16_PARAMS[static_cast<u8>(type)].init;
+}
+
+u16 Crc::crc16(Crc16Type type, const void* data, size_t length, u16 crc) {
+    const Crc16Params& params = CRC16_PARAMS[static_cast<u8>(type)];
+    const u16 (&t)[4][256] = CRC16_TABLES[params.table].entries;
+    const u8* bytes = static_cast<const u8*>(data);
+    u32 value = crc;
+
+    if (params.reflected) {
+        for (; length >= 4; length -= 4, bytes += 4) {
+            value ^= static_cast<u32>(bytes[0]) | (static_cast<u32>(bytes[1]) << 8);
+            value = t[3][value & 0xFF] ^ t[2][value >> 8] ^ t[1][bytes[2]] ^ t[0][bytes[3]];
+        }
+        for (; length > 0; length--) {
+            value = (value >> 8) ^ t[0][(value ^ *bytes++) & 0xFF];
+        }
+    } else {
+        for (; length >= 4; length -= 4, bytes += 4) {
+            value ^= (static_cast<u32>(bytes[0]) << 8) | bytes[1];
+            value = t[3][value >> 8] ^ t[2][value & 0xFF] ^ t[1][bytes[2]] ^ t[0][bytes[3]];
+        }
+        for (; length > 0; length--) {
+            value = ((value << 8) & 0xFFFF) ^ t[0][(value >> 8) ^ *bytes++];
+        }
+    }
+    return static_cast<u16>(value);
+}
+
+u8 Crc::crc8(Crc8Type type, const void* data, size_t length, u8 crc) {
+    // An 8-bit register shifts out completely per byte, so both bit
+    // orders fold the same way; only the tables differ
+    const u8 (&t)[4][256] = CRC8_TABLES[static_cast<u8>(type)].entries;
+    const u8* bytes = static_cast<const u8*>(data);
+
+    for (; length >= 4; length -= 4, bytes += 4) {
+        crc = static_cast<u8>(t[3][crc ^ bytes[0]] ^ t[2][bytes[1]] ^ t[1][bytes[2]] ^ t[0][bytes[3]]);
+    }
+    for (; length > 0; length--) {
+        crc = t[0][crc ^ *bytes++];
+    }
+    return crc;
+}
+
+} // namespace hal
+} // namespace embedded
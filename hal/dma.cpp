@@ -0,0 +1,309 @@
+/**
+ * @file dma.cpp
+ * @brief DMA controller implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "hal/dma.hpp"
+#include "system.hpp"
+#include "profiler.hpp"
+
+namespace embedded {
+namespace hal {
+
+namespace {
+
+constexpr u32 DMA1_BASE = 0x40026000;
+constexpr u32 DMA2_BASE = 0x40026400;
+
+volatile u32* const RCC_AHB1ENR = reinterpret_cast<volatile u32*>(0x40023830);
+
+constexpr u32 RCC_AHB1ENR_DMA1EN = BIT(21);
+constexpr u32 RCC_AHB1ENR_DMA2EN = BIT(22);
+
+// Controller registers (word offsets)
+constexpr u32 LISR  = 0;
+constexpr u32 LIFCR = 2;
+
+// Stream registers (word offsets from the stream base)
+constexpr u32 SxCR   = 0;
+constexpr u32 SxNDTR = 1;
+constexpr u32 SxPAR  = 2;
+constexpr u32 SxM0AR = 3;
+constexpr u32 SxM1AR = 4;
+constexpr u32 SxFCR  = 5;
+
+// SxCR bits
+constexpr u32 CR_EN     = BIT(0);
+constexpr u32 CR_DMEIE  = BIT(1);
+constexpr u32 CR_TEIE   = BIT(2);
+constexpr u32 CR_HTIE   = BIT(3);
+constexpr u32 CR_TCIE   = BIT(4);
+constexpr u32 CR_CIRC   = BIT(8);
+constexpr u32 CR_PINC   = BIT(9);
+constexpr u32 CR_MINC   = BIT(10);
+constexpr u32 CR_DBM    = BIT(18);
+constexpr u32 CR_CT     = BIT(19);
+
+// SxFCR bits
+constexpr u32 FCR_DMDIS = BIT(2);
+
+// Interrupt flags of one stream (before shifting into LISR/HISR)
+constexpr u32 FLAG_FE   = BIT(0);
+constexpr u32 FLAG_DME  = BIT(2);
+constexpr u32 FLAG_TE   = BIT(3);
+constexpr u32 FLAG_HT   = BIT(4);
+constexpr u32 FLAG_TC   = BIT(5);
+constexpr u32 FLAG_ALL  = FLAG_FE | FLAG_DME | FLAG_TE | FLAG_HT | FLAG_TC;
+
+constexpr u8 FLAG_SHIFT[4] = { 0, 6, 16, 22 };
+
+constexpr IrqNumber STREAM_IRQ[16] = {
+    IrqNumber::Dma1Stream0, IrqNumber::Dma1Stream1, IrqNumber::Dma1Stream2, IrqNumber::Dma1Stream3,
+    IrqNumber::Dma1Stream4, IrqNumber::Dma1Stream5, IrqNumber::Dma1Stream6, IrqNumber::Dma1Stream7,
+    IrqNumber::Dma2Stream0, IrqNumber::Dma2Stream1, IrqNumber::Dma2Stream2, IrqNumber::Dma2Stream3,
+    IrqNumber::Dma2Stream4, IrqNumber::Dma2Stream5, IrqNumber::Dma2Stream6, IrqNumber::Dma2Stream7
+};
+
+inline volatile u32* controllerRegisters(u8 index) {
+    return reinterpret_cast<volatile u32*>(index < 8 ? DMA1_BASE : DMA2_BASE);
+}
+
+// Bytes moved per memory burst, and held at the FIFO threshold
+inline u32 burstBytes(Dma::Width width, Dma::Burst burst) {
+    return (burst == Dma::Burst::Single) ? 0 : (1u << static_cast<u8>(width)) * (2u << static_cast<u8>(burst));
+}
+
+inline u32 thresholdBytes(Dma::FifoThreshold threshold) {
+    return 4 * (static_cast<u32>(threshold) + 1);
+}
+
+} // namespace
+
+Dma Dma::s_streams[16];
+
+Status Dma::allocate(const Request& request, Dma*& stream) {
+    if (request.controller > Controller::Dma2 || request.stream > 7 || request.channel > 7) {
+        return Status::InvalidArg;
+    }
+
+    u8 index = static_cast<u8>(static_cast<u8>(request.controller) * 8 + request.stream);
+    Dma& candidate = s_streams[index];
+
+    CriticalSection cs;
+
+    if (candidate.m_allocated) {
+        // The stream already serves another request mapping
+        return Status::Busy;
+    }
+
+    *RCC_AHB1ENR |= (request.controller == Controller::Dma1) ? RCC_AHB1ENR_DMA1EN
+                                                            : RCC_AHB1ENR_DMA2EN;
+
+    candidate.m_allocated = true;
+    candidate.m_request = request;
+    candidate.m_callback = nullptr;
+    candidate.m_context = nullptr;
+
+    stream = &candidate;
+    return Status::Ok;
+}
+
+void Dma::release(Dma* stream) {
+    if (stream == nullptr || !stream->m_allocated) {
+        return;
+    }
+
+    stream->stop();
+    System::disableIrq(STREAM_IRQ[stream->index()]);
+
+    CriticalSection cs;
+    stream->m_callback = nullptr;
+    stream->m_allocated = false;
+}
+
+Status Dma::configure(const Config& config, Callback callback, void* context) {
+    if (isBusy()) {
+        return Status::Busy;
+    }
+
+    bool memoryToMemory = (config.direction == Direction::MemoryToMemory);
+    if (memoryToMemory && (m_request.controller != Controller::Dma2 ||
+                           config.circular || config.doubleBuffer || !config.fifo)) {
+        return Status::InvalidArg;
+    }
+
+    if (!config.fifo) {
+        // Direct mode: no packing and no bursts
+        if (config.memoryBurst != Burst::Single || config.peripheralBurst != Burst::Single ||
+            config.memoryWidth != config.peripheralWidth) {
+            return Status::InvalidArg;
+        }
+    } else {
+        // A memory burst must fit the FIFO threshold level exactly
+        u32 burst = burstBytes(config.memoryWidth, config.memoryBurst);
+        u32 threshold = thresholdBytes(config.fifoThreshold);
+        if (burst != 0 && (burst > threshold || (threshold % burst) != 0)) {
+            return Status::InvalidArg;
+        }
+    }
+
+    u32 cr = (static_cast<u32>(m_request.channel) << 25) |
+             (static_cast<u32>(config.memoryBurst) << 23) |
+             (static_cast<u32>(config.peripheralBurst) << 21) |
+             (static_cast<u32>(config.priority) << 16) |
+             (static_cast<u32>(config.memoryWidth) << 13) |
+             (static_cast<u32>(config.peripheralWidth) << 11) |
+             (static_cast<u32>(config.direction) << 6) |
+             CR_TCIE | CR_TEIE;
+
+    if (config.memoryIncrement)     cr |= CR_MINC;
+    if (config.peripheralIncrement) cr |= CR_PINC;
+    if (config.circular)            cr |= CR_CIRC;
+    if (config.doubleBuffer)        cr |= CR_DBM | CR_CIRC;
+    if (config.halfTransferIrq)     cr |= CR_HTIE;
+    if (!config.fifo)               cr |= CR_DMEIE;
+
+    volatile u32* regs = registers();
+    regs[SxCR] = cr;
+    regs[SxFCR] = config.fifo ? (FCR_DMDIS | static_cast<u32>(config.fifoThreshold)) : 0;
+
+    {
+        CriticalSection cs;
+        m_callback = callback;
+        m_context = context;
+    }
+
+    System::setIrqPriority(STREAM_IRQ[index()], config.irqPriority);
+    System::enableIrq(STREAM_IRQ[index()]);
+
+    return Status::Ok;
+}
+
+Status Dma::start(volatile const void* peripheral, const void* memory0, size_t count,
+                  const void* memory1) {
+    volatile u32* regs = registers();
+
+    if (count == 0 || count > 0xFFFF || memory0 == nullptr ||
+        ((regs[SxCR] & CR_DBM) && memory1 == nullptr)) {
+        return Status::InvalidArg;
+    }
+
+    stop();
+
+    regs[SxNDTR] = static_cast<u32>(count);
+    regs[SxPAR] = static_cast<u32>(reinterpret_cast<uintptr_t>(peripheral));
+    regs[SxM0AR] = static_cast<u32>(reinterpret_cast<uintptr_t>(memory0));
+    if (memory1 != nullptr) {
+        regs[SxM1AR] = static_cast<u32>(reinterpret_cast<uintptr_t>(memory1));
+    }
+    regs[SxCR] &= ~CR_CT;
+
+    // Buffer contents written by the CPU must land before the stream starts
+    DMB();
+    regs[SxCR] |= CR_EN;
+
+    return Status::Ok;
+}
+
+void Dma::stop() {
+    volatile u32* regs = registers();
+
+    regs[SxCR] &= ~CR_EN;
+    while (regs[SxCR] & CR_EN) {
+        // The stream finishes its current beat before it disables
+    }
+    clearFlags();
+}
+
+bool Dma::isBusy() const {
+    return (registers()[SxCR] & CR_EN) != 0;
+}
+
+size_t Dma::getRemaining() const {
+    return registers()[SxNDTR];
+}
+
+u8 Dma::getCurrentTarget() const {
+    return (registers()[SxCR] & CR_CT) ? 1 : 0;
+}
+
+Status Dma::setMemory(u8 target, const void* memory) {
+    volatile u32* regs = registers();
+
+    if (target > 1) {
+        return Status::InvalidArg;
+    }
+    if (isBusy() && getCurrentTarget() == target) {
+        return Status::Busy;
+    }
+
+    regs[target == 0 ? SxM0AR : SxM1AR] = static_cast<u32>(reinterpret_cast<uintptr_t>(memory));
+    return Status::Ok;
+}
+
+void Dma::dispatch(u8 index) {
+    PROFILE_ISR(Dma);
+    Dma& stream = s_streams[index];
+    u8 number = index & 7;
+
+    // LISR/LIFCR serve streams 0-3, HISR/HIFCR (next word) streams 4-7
+    volatile u32* ctrl = controllerRegisters(index);
+    u32 bank = (number < 4) ? 0 : 1;
+    u32 shift = FLAG_SHIFT[number & 3];
+
+    u32 flags = (ctrl[LISR + bank] >> shift) & FLAG_ALL;
+    ctrl[LIFCR + bank] = flags << shift;
+
+    u32 cr = stream.registers()[SxCR];
+    u32 events = 0;
+    if ((flags & FLAG_HT) && (cr & CR_HTIE)) {
+        events |= EVENT_HALF;
+    }
+    if (flags & FLAG_TC) {
+        events |= EVENT_COMPLETE;
+    }
+    if (flags & (FLAG_TE | FLAG_DME)) {
+        events |= EVENT_ERROR;
+    }
+
+    if (events != 0 && stream.m_callback != nullptr) {
+        stream.m_callback(events, stream.m_context);
+    }
+}
+
+volatile u32* Dma::registers() const {
+    u8 number = index() & 7;
+    return controllerRegisters(index()) + (0x10 + 0x18 * number) / 4;
+}
+
+void Dma::clearFlags() {
+    u8 number = index() & 7;
+    volatile u32* ctrl = controllerRegisters(index());
+    ctrl[LIFCR + ((number < 4) ? 0 : 1)] = FLAG_ALL << FLAG_SHIFT[number & 3];
+}
+
+} // namespace hal
+} // namespace embedded
+
+/*============================================================================
+ * Interrupt Handlers
+ *===========================================================================*/
+extern "C" void DMA1_Stream0_IRQHandler(void) { embedded::hal::Dma::dispatch(0); }
+extern "C" void DMA1_Stream1_IRQHandler(void) { embedded::hal::Dma::dispatch(1); }
+extern "C" void DMA1_Stream2_IRQHandler(void) { embedded::hal::Dma::dispatch(2); }
+extern "C" void DMA1_Stream3_IRQHandler(void) { embedded::hal::Dma::dispatch(3); }
+extern "C" void DMA1_Stream4_IRQHandler(void) { embedded::hal::Dma::dispatch(4); }
+extern "C" void DMA1_Stream5_IRQHandler(void) { embedded::hal::Dma::dispatch(5); }
+extern "C" void DMA1_Stream6_IRQHandler(void) { embedded::hal::Dma::dispatch(6); }
+extern "C" void DMA1_Stream7_IRQHandler(void) { embedded::hal::Dma::dispatch(7); }
+extern "C" void DMA2_Stream0_IRQHandler(void) { embedded::hal::Dma::dispatch(8); }
+extern "C" void DMA2_Stream1_IRQHandler(void) { embedded::hal::Dma::dispatch(9); }
+extern "C" void DMA2_Stream2_IRQHandler(void) { embedded::hal::Dma::dispatch(10); }
+extern "C" void DMA2_Stream3_IRQHandler(void) { embedded::hal::Dma::dispatch(11); }
+extern "C" void DMA2_Stream4_IRQHandler(void) { embedded::hal::Dma::dispatch(12); }
+extern "C" void DMA2_Stream5_IRQHandler(void) { embedded::hal::Dma::dispatch(13); }
+extern "C" void DMA2_Stream6_IRQHandler(void) { embedded::hal::Dma::dispatch(14); }
+extern "C" void DMA2_Stream7_IRQHandler(void) { embedded::hal::Dma::dispatch(15); }
@@ -0,0 +1,285 @@
+/**
+ * @file dma.hpp
+ * @brief DMA controller Hardware Abstraction Layer
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef HAL_DMA_HPP
+#define HAL_DMA_HPP
+
+#include "types.hpp"
+
+namespace embedded {
+namespace hal {
+
+/**
+ * @class Dma
+ * @brief STM32F4 DMA stream (DMA1/DMA2, 8 streams each)
+ *
+ * Streams are statically allocated objects handed out by allocate()
+ * for a peripheral request (controller, stream, channel). A stream has
+ * one owner at a time, so two drivers whose request mappings collide on
+ * the same stream are detected at allocation instead of corrupting each
+ * other's transfers. Stream interrupts are routed to the owner's
+ * callback through dispatch().
+ *
+ * Only DMA2 can reach AHB peripherals (GPIO) and do memory-to-memory
+ * transfers. Neither controller can access CCM.
+ */
+class Dma {
+public:
+    /**
+     * @brief DMA controller
+     */
+    enum class Controller : u8 {
+        Dma1 = 0,
+        Dma2 = 1
+    };
+
+    /**
+     * @brief Transfer direction
+     */
+    enum class Direction : u8 {
+        PeripheralToMemory  = 0,
+        MemoryToPeripheral  = 1,
+        MemoryToMemory      = 2     ///< DMA2 only; PAR is the source
+    };
+
+    /**
+     * @brief Data item width
+     */
+    enum class Width : u8 {
+        Byte     = 0,
+        HalfWord = 1,
+        Word     = 2
+    };
+
+    /**
+     * @brief Burst length (requires FIFO mode)
+     */
+    enum class Burst : u8 {
+        Single = 0,
+        Incr4  = 1,
+        Incr8  = 2,
+        Incr16 = 3
+    };
+
+    /**
+     * @brief FIFO threshold
+     */
+    enum class FifoThreshold : u8 {
+        Quarter       = 0,
+        Half          = 1,
+        ThreeQuarters = 2,
+        Full          = 3
+    };
+
+    /**
+     * @brief Arbitration priority between streams of one controller
+     */
+    enum class Priority : u8 {
+        Low      = 0,
+        Medium   = 1,
+        High     = 2,
+        VeryHigh = 3
+    };
+
+    /**
+     * @brief Peripheral request mapping (RM0090 tables 42/43)
+     */
+    struct Request {
+        Controller  controller;
+        u8          stream;         ///< 0-7
+        u8          channel;        ///< 0-7
+    };
+
+    /**
+     * @brief Stream configuration
+     *
+     * The defaults use the FIFO with single-beat bursts, which suits
+     * byte-wide peripherals. For bulk memory traffic widen memoryWidth
+     * and use Incr4 bursts to cut AHB arbitration.
+     */
+    struct Config {
+        Direction       direction           = Direction::PeripheralToMemory;
+        Width           peripheralWidth     = Width::Byte;
+        Width           memoryWidth         = Width::Byte;
+        bool            peripheralIncrement = false;
+        bool            memoryIncrement     = true;
+        bool            circular            = false;
+        bool            doubleBuffer        = false;    ///< DBM: alternate memory0/memory1
+        Priority        priority            = Priority::Medium;
+        bool            fifo                = true;     ///< false: direct mode
+        FifoThreshold   fifoThreshold       = FifoThreshold::Full;
+        Burst           memoryBurst         = Burst::Single;
+        Burst           peripheralBurst     = Burst::Single;
+        bool            halfTransferIrq     = false;
+        IrqPriority     irqPriority         = IrqPriority::Medium;
+    };
+
+    /// Callback event flags
+    static constexpr u32 EVENT_HALF     = BIT(0);   ///< Half transfer
+    static constexpr u32 EVENT_COMPLETE = BIT(1);   ///< Transfer complete (or buffer switch in DBM)
+    static constexpr u32 EVENT_ERROR    = BIT(2);   ///< Transfer or direct-mode error
+
+    /**
+     * @brief Callback function type for stream events
+     * @param events EVENT_* flags
+     * @param context User context
+     */
+    using Callback = void (*)(u32 events, void* context);
+
+    /**
+     * @brief Claim the stream for a request
+     * @param request Peripheral request mapping
+     * @param stream Receives the stream on success
+     * @return Status::Ok, Status::InvalidArg for an invalid mapping, or
+     *         Status::Busy if another owner holds the stream
+     */
+    static Status allocate(const Request& request, Dma*& stream);
+
+    /**
+     * @brief Release a stream (stops any transfer)
+     * @param stream Stream from allocate()
+     */
+    static void release(Dma* stream);
+
+    /**
+     * @brief Configure the stream
+     * @param config Stream configuration
+     * @param callback Event callback, run in interrupt context
+     * @param context User context passed to callback
+     * @return Status::Ok, Status::InvalidArg for an invalid combination
+     *         (burst without FIFO, burst larger than the threshold,
+     *         memory-to-memory on DMA1 or circular), Status::Busy while
+     *         a transfer runs
+     */
+    Status configure(const Config& config, Callback callback = nullptr, void* context = nullptr);
+
+    /**
+     * @brief Start a transfer
+     * @param peripheral Peripheral register (source for memory-to-memory)
+     * @param memory0 Memory buffer (destination for memory-to-memory)
+     * @param count Number of peripheral-width items (1-65535)
+     * @param memory1 Second buffer for double-buffer mode
+     * @return Status::Ok on success
+     */
+    Status start(volatile const void* peripheral, const void* memory0, size_t count,
+                 const void* memory1 = nullptr);
+
+    /**
+     * @brief Stop the transfer and wait for the stream to disable
+     */
+    void stop();
+
+    /**
+     * @brief Check whether the stream is enabled
+     * @return true while a transfer runs
+     */
+    bool isBusy() const;
+
+    /**
+     * @brief Get items not yet transferred
+     * @return NDTR value
+     */
+    size_t getRemaining() const;
+
+    /**
+     * @brief Get the buffer the stream is currently using (DBM)
+     * @return 0 for memory0, 1 for memory1
+     */
+    u8 getCurrentTarget() const;
+
+    /**
+     * @brief Replace the idle buffer in double-buffer mode
+     * @param target Buffer to replace (must not be the current target)
+     * @param memory New buffer
+     * @return Status::Ok, or Status::Busy if target is in use
+     */
+    Status setMemory(u8 target, const void* memory);
+
+    /**
+     * @brief Get the request this stream was allocated for
+     * @return Request mapping
+     */
+    const Request& getRequest() const { return m_request; }
+
+    /**
+     * @brief Serve a stream interrupt (called from DMA vectors)
+     * @param index Controller * 8 + stream
+     */
+    static void dispatch(u8 index);
+
+private:
+    Request     m_request;
+    bool        m_allocated;
+    Callback    m_callback;
+    void*       m_context;
+
+    static Dma s_streams[16];
+
+    Dma() = default;
+    Dma(const Dma&) = delete;
+    Dma& operator=(const Dma&) = delete;
+
+    u8 index() const { return static_cast<u8>(this - s_streams); }
+    volatile u32* registers() const;
+    void clearFlags();
+};
+
+/**
+ * @brief Request mappings of the peripherals used by the HAL
+ *
+ * Where RM0090 offers alternatives the second one is named *Alt.
+ */
+namespace DmaRequest {
+    constexpr Dma::Request Usart1Rx    = { Dma::Controller::Dma2, 2, 4 };
+    constexpr Dma::Request Usart1RxAlt = { Dma::Controller::Dma2, 5, 4 };
+    constexpr Dma::Request Usart1Tx    = { Dma::Controller::Dma2, 7, 4 };
+    constexpr Dma::Request Usart2Rx    = { Dma::Controller::Dma1, 5, 4 };
+    constexpr Dma::Request Usart2Tx    = { Dma::Controller::Dma1, 6, 4 };
+    constexpr Dma::Request Usart3Rx    = { Dma::Controller::Dma1, 1, 4 };
+    constexpr Dma::Request Usart3Tx    = { Dma::Controller::Dma1, 3, 4 };
+    constexpr Dma::Request Usart6Rx    = { Dma::Controller::Dma2, 1, 5 };
+    constexpr Dma::Request Usart6Tx    = { Dma::Controller::Dma2, 6, 5 };
+
+    constexpr Dma::Request Spi1Rx      = { Dma::Controller::Dma2, 0, 3 };
+    constexpr Dma::Request Spi1RxAlt   = { Dma::Controller::Dma2, 2, 3 };
+    constexpr Dma::Request Spi1Tx      = { Dma::Controller::Dma2, 3, 3 };
+    constexpr Dma::Request Spi1TxAlt   = { Dma::Controller::Dma2, 5, 3 };
+    constexpr Dma::Request Spi2Rx      = { Dma::Controller::Dma1, 3, 0 };
+    constexpr Dma::Request Spi2Tx      = { Dma::Controller::Dma1, 4, 0 };
+    constexpr Dma::Request Spi3Rx      = { Dma::Controller::Dma1, 0, 0 };
+    constexpr Dma::Request Spi3Tx      = { Dma::Controller::Dma1, 5, 0 };
+
+    constexpr Dma::Request I2c1Rx      = { Dma::Controller::Dma1, 0, 1 };
+    constexpr Dma::Request I2c1RxAlt   = { Dma::Controller::Dma1, 5, 1 };
+    constexpr Dma::Request I2c1Tx      = { Dma::Controller::Dma1, 6, 1 };
+    constexpr Dma::Request I2c1TxAlt   = { Dma::Controller::Dma1, 7, 1 };
+    constexpr Dma::Request I2c2Rx      = { Dma::Controller::Dma1, 2, 7 };
+    constexpr Dma::Request I2c2Tx      = { Dma::Controller::Dma1, 7, 7 };
+    constexpr Dma::Request I2c3Rx      = { Dma::Controller::Dma1, 2, 3 };
+    constexpr Dma::Request I2c3Tx      = { Dma::Controller::Dma1, 4, 3 };
+
+    constexpr Dma::Request Adc1        = { Dma::Controller::Dma2, 0, 0 };
+    constexpr Dma::Request Adc1Alt     = { Dma::Controller::Dma2, 4, 0 };
+    constexpr Dma::Request Adc2        = { Dma::Controller::Dma2, 2, 1 };
+    constexpr Dma::Request Adc3        = { Dma::Controller::Dma2, 0, 2 };
+
+    constexpr Dma::Request Tim1Up      = { Dma::Controller::Dma2, 5, 6 };
+    constexpr Dma::Request Tim2Up      = { Dma::Controller::Dma1, 1, 3 };
+    constexpr Dma::Request Tim3Up      = { Dma::Controller::Dma1, 2, 5 };
+    constexpr Dma::Request Tim4Up      = { Dma::Controller::Dma1, 6, 2 };
+    constexpr Dma::Request Tim5Up      = { Dma::Controller::Dma1, 0, 6 };
+    constexpr Dma::Request Tim8Up      = { Dma::Controller::Dma2, 1, 7 };
+
+    /// Memory-to-memory and GPIO waveforms (any free DMA2 stream)
+    constexpr Dma::Request Memory      = { Dma::Controller::Dma2, 4, 0 };
+} // namespace DmaRequest
+
+} // namespace hal
+} // namespace embedded
+
+#endif // HAL_DMA_HPP
@@ -0,0 +1,201 @@
+/**
+ * @file exti.cpp
+ * @brief External interrupt (EXTI) line dispatch implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "hal/exti.hpp"
+#include "system.hpp"
+#include "profiler.hpp"
+
+namespace embedded {
+namespace hal {
+
+namespace {
+
+volatile u32* const RCC_APB2ENR   = reinterpret_cast<volatile u32*>(0x40023844);
+volatile u32* const SYSCFG_EXTICR = reinterpret_cast<volatile u32*>(0x40013808);
+volatile u32* const EXTI_IMR      = reinterpret_cast<volatile u32*>(0x40013C00);
+volatile u32* const EXTI_RTSR     = reinterpret_cast<volatile u32*>(0x40013C08);
+volatile u32* const EXTI_FTSR     = reinterpret_cast<volatile u32*>(0x40013C0C);
+volatile u32* const EXTI_SWIER    = reinterpret_cast<volatile u32*>(0x40013C10);
+volatile u32* const EXTI_PR       = reinterpret_cast<volatile u32*>(0x40013C14);
+
+constexpr u32 RCC_APB2ENR_SYSCFGEN = BIT(14);
+constexpr u32 GPIO_PORT_BASE       = 0x40020000;
+constexpr u32 GPIO_PORT_STRIDE     = 0x400;
+constexpr u32 GPIO_PORT_COUNT      = 9;
+
+constexpr u32 LINES_9_5            = 0x03E0;
+constexpr u32 LINES_15_10          = 0xFC00;
+
+/**
+ * @brief Map a line to its NVIC vector and the lines sharing it
+ */
+void vectorOf(u8 pin, IrqNumber& irq, u32& group) {
+    if (pin <= 4) {
+        irq = static_cast<IrqNumber>(static_cast<i16>(IrqNumber::Exti0) + pin);
+        group = BIT(pin);
+    } else if (pin <= 9) {
+        irq = IrqNumber::Exti9_5;
+        group = LINES_9_5;
+    } else {
+        irq = IrqNumber::Exti15_10;
+        group = LINES_15_10;
+    }
+}
+
+} // namespace
+
+// Dispatch table, kept in CCM for zero-wait-state lookup
+CCM_BSS Exti::Line Exti::s_lines[16];
+
+Status Exti::attach(void* port, u8 pin, GPIO::Trigger trigger,
+                    GPIO::Callback callback, void* context, IrqPriority priority) {
+    u32 base = static_cast<u32>(reinterpret_cast<uintptr_t>(port));
+    if (pin >= 16 || callback == nullptr || base < GPIO_PORT_BASE ||
+        (base - GPIO_PORT_BASE) % GPIO_PORT_STRIDE != 0 ||
+        (base - GPIO_PORT_BASE) / GPIO_PORT_STRIDE >= GPIO_PORT_COUNT) {
+        return Status::InvalidArg;
+    }
+    u8 index = static_cast<u8>((base - GPIO_PORT_BASE) / GPIO_PORT_STRIDE);
+
+    CriticalSection cs;
+
+    Line& line = s_lines[pin];
+    if (line.callback != nullptr && line.port != index) {
+        return Status::Busy;
+    }
+
+    // Route the pin's port to the line
+    *RCC_APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+    u32 shift = (pin % 4) * 4;
+    volatile u32* exticr = &SYSCFG_EXTICR[pin / 4];
+    *exticr = (*exticr & ~(0xFUL << shift)) | (static_cast<u32>(index) << shift);
+
+    line.callback = callback;
+    line.context = context;
+    line.port = index;
+    line.priority = priority;
+
+    u8 mode = static_cast<u8>(trigger);
+    if (mode & static_cast<u8>(GPIO::Trigger::Rising)) {
+        *EXTI_RTSR |= BIT(pin);
+    } else {
+        *EXTI_RTSR &= ~BIT(pin);
+    }
+    if (mode & static_cast<u8>(GPIO::Trigger::Falling)) {
+        *EXTI_FTSR |= BIT(pin);
+    } else {
+        *EXTI_FTSR &= ~BIT(pin);
+    }
+
+    *EXTI_PR = BIT(pin);
+    *EXTI_IMR |= BIT(pin);
+
+    updateVector(pin);
+    return Status::Ok;
+}
+
+Status Exti::detach(u8 pin) {
+    if (pin >= 16) {
+        return Status::InvalidArg;
+    }
+
+    CriticalSection cs;
+
+    *EXTI_IMR &= ~BIT(pin);
+    *EXTI_RTSR &= ~BIT(pin);
+    *EXTI_FTSR &= ~BIT(pin);
+    *EXTI_PR = BIT(pin);
+
+    s_lines[pin].callback = nullptr;
+    s_lines[pin].context = nullptr;
+
+    updateVector(pin);
+    return Status::Ok;
+}
+
+void Exti::trigger(u8 pin) {
+    if (pin < 16) {
+        *EXTI_SWIER = BIT(pin);
+    }
+}
+
+RAM_FUNC void Exti::dispatch(u32 mask) {
+    PROFILE_ISR(Exti);
+    u32 pending = *EXTI_PR & *EXTI_IMR & mask;
+
+    // Acknowledge before the callbacks so edges arriving meanwhile re-pend
+    *EXTI_PR = pending;
+
+    while (pending != 0) {
+        u32 pin = static_cast<u32>(__builtin_ctz(pending));
+        pending &= pending - 1;
+
+        const Line& line = s_lines[pin];
+        line.callback(line.context);
+    }
+}
+
+void Exti::updateVector(u8 pin) {
+    IrqNumber irq;
+    u32 group;
+    vectorOf(pin, irq, group);
+
+    // The shared vector runs at the most urgent attached priority
+    bool used = false;
+    u8 priority = static_cast<u8>(IrqPriority::Lowest);
+    for (u8 i = 0; i < 16; i++) {
+        if ((group & BIT(i)) && s_lines[i].callback != nullptr) {
+            used = true;
+            if (static_cast<u8>(s_lines[i].priority) < priority) {
+                priority = static_cast<u8>(s_lines[i].priority);
+            }
+        }
+    }
+
+    if (!used) {
+        System::disableIrq(irq);
+        return;
+    }
+
+    System::setIrqPriority(irq, static_cast<IrqPriority>(priority));
+    System::enableIrq(irq);
+}
+
+} // namespace hal
+} // namespace embedded
+
+/*============================================================================
+ * Interrupt Handlers (run from SRAM for bounded edge-to-callback latency)
+ *===========================================================================*/
+extern "C" RAM_FUNC void EXTI0_IRQHandler(void) {
+    embedded::hal::Exti::dispatch(BIT(0));
+}
+
+extern "C" RAM_FUNC void EXTI1_IRQHandler(void) {
+    embedded::hal::Exti::dispatch(BIT(1));
+}
+
+extern "C" RAM_FUNC void EXTI2_IRQHandler(void) {
+    embedded::hal::Exti::dispatch(BIT(2));
+}
+
+extern "C" RAM_FUNC void EXTI3_IRQHandler(void) {
+    embedded::hal::Exti::dispatch(BIT(3));
+}
+
+extern "C" RAM_FUNC void EXTI4_IRQHandler(void) {
+    embedded::hal::Exti::dispatch(BIT(4));
+}
+
+extern "C" RAM_FUNC void EXTI9_5_IRQHandler(void) {
+    embedded::hal::Exti::dispatch(embedded::hal::LINES_9_5);
+}
+
+extern "C" RAM_FUNC void EXTI15_10_IRQHandler(void) {
+    embedded::hal::Exti::dispatch(embedded::hal::LINES_15_10);
+}
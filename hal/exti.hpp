@@ -0,0 +1,83 @@
+/**
+ * @file exti.hpp
+ * @brief External interrupt (EXTI) line dispatch
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef HAL_EXTI_HPP
+#define HAL_EXTI_HPP
+
+#include "types.hpp"
+#include "hal/gpio.hpp"
+
+namespace embedded {
+namespace hal {
+
+/**
+ * @class Exti
+ * @brief Constant-time dispatch of GPIO edge interrupts
+ *
+ * Each of the 16 EXTI lines has one slot in a static table (in CCM).
+ * Every vector reads the pending lines of its group once and walks them
+ * with count-trailing-zeros, so the shared EXTI9_5 and EXTI15_10
+ * vectors serve several simultaneous edges per interrupt entry and the
+ * cost per line is constant.
+ *
+ * A line belongs to one port at a time (PA3 and PB3 share line 3).
+ * Lines sharing a vector run at the most urgent priority attached to it.
+ */
+class Exti {
+public:
+    /**
+     * @brief Attach a callback to a pin edge
+     * @param port GPIO port base address
+     * @param pin Pin number, which is also the EXTI line (0-15)
+     * @param trigger Trigger edge configuration
+     * @param callback Callback, run in interrupt context
+     * @param context User context passed to callback
+     * @param priority NVIC priority of the line's vector
+     * @return Status::Ok, Status::InvalidArg, or Status::Busy if the line
+     *         is attached to another port
+     */
+    static Status attach(void* port, u8 pin, GPIO::Trigger trigger,
+                         GPIO::Callback callback, void* context = nullptr,
+                         IrqPriority priority = IrqPriority::Medium);
+
+    /**
+     * @brief Detach a line and mask its interrupt
+     * @param pin EXTI line (0-15)
+     * @return Status::Ok on success
+     */
+    static Status detach(u8 pin);
+
+    /**
+     * @brief Trigger a line from software
+     * @param pin EXTI line (0-15)
+     */
+    static void trigger(u8 pin);
+
+    /**
+     * @brief Serve pending lines of a group (called from EXTI vectors)
+     * @param mask Lines handled by the calling vector
+     */
+    static void dispatch(u32 mask);
+
+private:
+    struct Line {
+        GPIO::Callback  callback;
+        void*           context;
+        u8              port;           ///< Port index (A = 0)
+        IrqPriority     priority;
+    };
+
+    static Line s_lines[16];
+
+    static void updateVector(u8 pin);
+};
+
+} // namespace hal
+} // namespace embedded
+
+#endif // HAL_EXTI_HPP
@@ -11,6 +11,10 @@
 
 #include "types.hpp"
 
+#if EMBEDDED_HOST_BUILD
+#include "sim/sim.hpp"
+#endif
+
 namespace embedded {
 namespace hal {
 
@@ -67,6 +71,115 @@ public:
      */
     using Callback = void (*)(void* context);
 
+    /**
+     * @class Group
+     * @brief Several pins of one port driven together
+     *
+     * Computes BSRR set/reset masks so all pins of the group change in
+     * one store, without the glitches of per-pin writes. Pins of the
+     * group need not be contiguous; value bits map one-to-one onto port
+     * bits (value bit n drives pin n).
+     *
+     * For waveform output, fill a buffer with encode() words and stream
+     * it to bsrrAddress() with a DMA2 memory-to-peripheral transfer paced
+     * by a timer (DMA1 cannot reach the AHB1 GPIO ports).
+     */
+    class Group {
+    public:
+        /**
+         * @brief Constructor
+         * @param port GPIO port base address
+         * @param mask Pins belonging to the group
+         */
+        Group(void* port, u16 mask)
+            : m_bsrr(reinterpret_cast<volatile u32*>(static_cast<u8*>(port) + 0x18))
+            , m_idr(reinterpret_cast<volatile u32*>(static_cast<u8*>(port) + 0x10))
+            , m_mask(mask) {}
+
+        /**
+         * @brief Compute the BSRR word driving mask to value
+         * @param mask Pins to update
+         * @param value New pin levels (bits outside mask are ignored)
+         * @return BSRR word (set bits low half, reset bits high half)
+         */
+        static constexpr u32 encode(u16 mask, u16 value) {
+            return (static_cast<u32>(static_cast<u16>(~value) & mask) << 16) | (value & mask);
+        }
+
+        /**
+         * @brief Encode a sequence of values into BSRR words
+         * @param mask Pins to update
+         * @param values Pin levels, one per step
+         * @param words Output BSRR words
+         * @param count Number of steps
+         */
+        static void encode(u16 mask, const u16* values, u32* words, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                words[i] = encode(mask, values[i]);
+            }
+        }
+
+        /**
+         * @brief Drive all group pins to value in one store
+         * @param value New pin levels
+         */
+        void write(u16 value) { store(encode(m_mask, value)); }
+
+        /**
+         * @brief Set and clear group pins in one store
+         * @param set Pins to set high
+         * @param reset Pins to set low (set wins where both are given)
+         */
+        void apply(u16 set, u16 reset) {
+            store((static_cast<u32>(reset & m_mask) << 16) | (set & m_mask));
+        }
+
+        /**
+         * @brief Set all group pins high
+         */
+        void setHigh() { store(m_mask); }
+
+        /**
+         * @brief Set all group pins low
+         */
+        void setLow() { store(static_cast<u32>(m_mask) << 16); }
+
+        /**
+         * @brief Read input levels of the group pins
+         * @return Pin levels masked to the group
+         */
+        u16 read() const {
+#if EMBEDDED_HOST_BUILD
+            sim::syncGpio(m_idr);
+#endif
+            return static_cast<u16>(*m_idr & m_mask);
+        }
+
+        /**
+         * @brief Get group pin mask
+         * @return Mask of pins in the group
+         */
+        u16 getMask() const { return m_mask; }
+
+        /**
+         * @brief Get BSRR address as a DMA destination
+         * @return Address of the port BSRR register
+         */
+        volatile u32* bsrrAddress() const { return m_bsrr; }
+
+    private:
+        volatile u32*   m_bsrr;
+        volatile u32*   m_idr;
+        u16             m_mask;
+
+        void store(u32 bits) {
+            *m_bsrr = bits;
+#if EMBEDDED_HOST_BUILD
+            sim::syncGpio(m_bsrr);
+#endif
+        }
+    };
+
     /**
      * @brief Constructor
      * @param port GPIO port base address
@@ -148,12 +261,18 @@ public:
 
     /**
      * @brief Enable interrupt on pin
+     * 
+     * Dispatched through the Exti line table (see hal/exti.hpp).
+     * 
      * @param trigger Trigger edge configuration
      * @param callback Callback function
      * @param context User context passed to callback
-     * @return Status::Ok on success
+     * @param priority NVIC priority of the EXTI vector
+     * @return Status::Ok on success, Status::Busy if the EXTI line is
+     *         used by the same pin of another port
      */
-    Status enableInterrupt(Trigger trigger, Callback callback, void* context = nullptr);
+    Status enableInterrupt(Trigger trigger, Callback callback, void* context = nullptr,
+                           IrqPriority priority = IrqPriority::Medium);
 
     /**
      * @brief Disable interrupt on pin
@@ -0,0 +1,204 @@
+/**
+ * @file gpio_pin.hpp
+ * @brief Compile-time GPIO pins and ports
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef HAL_GPIO_PIN_HPP
+#define HAL_GPIO_PIN_HPP
+
+#include "types.hpp"
+#include "hal/gpio.hpp"
+
+#if EMBEDDED_HOST_BUILD
+#include "sim/sim.hpp"
+#endif
+
+namespace embedded {
+namespace hal {
+
+/**
+ * @brief GPIO port base addresses (STM32F4, AHB1)
+ */
+enum class PortId : u32 {
+    A = 0x40020000,
+    B = 0x40020400,
+    C = 0x40020800,
+    D = 0x40020C00,
+    E = 0x40021000,
+    F = 0x40021400,
+    G = 0x40021800,
+    H = 0x40021C00,
+    I = 0x40022000
+};
+
+/**
+ * @class GpioPort
+ * @brief Whole-port access with the port fixed at compile time
+ *
+ * Every access is a single load or store to a constant address.
+ *
+ * @tparam Port Port base address
+ */
+template <PortId Port>
+class GpioPort {
+public:
+    static constexpr u32 BASE = static_cast<u32>(Port);
+
+    /**
+     * @brief Set pins high
+     * @param mask Pins to set
+     */
+    static void set(u16 mask) { bsrr() = mask; }
+
+    /**
+     * @brief Set pins low
+     * @param mask Pins to clear
+     */
+    static void reset(u16 mask) { bsrr() = static_cast<u32>(mask) << 16; }
+
+    /**
+     * @brief Drive the pins in mask to value in one atomic store
+     * @param mask Pins to update
+     * @param value New pin levels (bits outside mask are ignored)
+     */
+    static void write(u16 mask, u16 value) {
+        bsrr() = GPIO::Group::encode(mask, value);
+    }
+
+    /**
+     * @brief Get runtime group for pins of this port
+     * @param mask Pins belonging to the group
+     * @return Group object (e.g. for bsrrAddress())
+     */
+    static GPIO::Group group(u16 mask) { return GPIO::Group(base(), mask); }
+
+    /**
+     * @brief Read input levels of the port
+     * @return IDR value
+     */
+    static u16 read() { return static_cast<u16>(idr()); }
+
+    /**
+     * @brief Read output latch of the port
+     * @return ODR value
+     */
+    static u16 readOutput() { return static_cast<u16>(odr()); }
+
+    /**
+     * @brief Get port base for the runtime GPIO API
+     * @return Port base address
+     */
+#if EMBEDDED_HOST_BUILD
+    static void* base() { return sim::gpioPort(BASE); }
+
+    // Every access first folds the previous BSRR store into ODR/IDR
+    static volatile u32& idr()  { return sync()->idr; }
+    static volatile u32& odr()  { return sync()->odr; }
+    static volatile u32& bsrr() { return sync()->bsrr; }
+
+private:
+    static sim::GpioRegisters* sync() {
+        sim::GpioRegisters* port = sim::gpioPort(BASE);
+        sim::syncGpio(port);
+        return port;
+    }
+#else
+    static void* base() { return reinterpret_cast<void*>(BASE); }
+
+    static volatile u32& idr()  { return *reinterpret_cast<volatile u32*>(BASE + 0x10); }
+    static volatile u32& odr()  { return *reinterpret_cast<volatile u32*>(BASE + 0x14); }
+    static volatile u32& bsrr() { return *reinterpret_cast<volatile u32*>(BASE + 0x18); }
+#endif
+};
+
+/**
+ * @class GpioPin
+ * @brief Single pin with port and pin fixed at compile time
+ *
+ * Output operations compile to one BSRR store and reads to one IDR load,
+ * for bit-banged protocols and timing markers. Configuration (mode,
+ * pull, speed, interrupts) goes through the runtime GPIO returned by
+ * toGpio(), which also serves APIs taking a hal::GPIO*.
+ *
+ * @code
+ * using Marker = GpioPin<PortId::B, 7>;
+ * GPIO marker = Marker::toGpio();
+ * marker.setMode(GPIO::Mode::Output);
+ * Marker::setHigh();
+ * @endcode
+ *
+ * @tparam Port Port base address
+ * @tparam Pin Pin number (0-15)
+ */
+template <PortId Port, u8 Pin>
+class GpioPin {
+    static_assert(Pin < 16, "GPIO pin must be 0-15");
+
+public:
+    using PortType = GpioPort<Port>;
+
+    static constexpr u16 MASK = static_cast<u16>(1u << Pin);
+
+    /**
+     * @brief Set pin output high
+     */
+    static void setHigh() { PortType::bsrr() = MASK; }
+
+    /**
+     * @brief Set pin output low
+     */
+    static void setLow() { PortType::bsrr() = static_cast<u32>(MASK) << 16; }
+
+    /**
+     * @brief Write pin state
+     * @param state Pin state
+     */
+    static void write(PinState state) {
+        PortType::bsrr() = (state == PinState::High) ? MASK : (static_cast<u32>(MASK) << 16);
+    }
+
+    /**
+     * @brief Toggle pin output
+     *
+     * One ODR load and one BSRR store; unlike an ODR read-modify-write it
+     * cannot clobber other pins changed by an interrupt in between.
+     */
+    static void toggle() {
+        u32 odr = PortType::odr();
+        PortType::bsrr() = ((odr & MASK) << 16) | (~odr & MASK);
+    }
+
+    /**
+     * @brief Read pin state
+     * @return Current pin state
+     */
+    static PinState read() {
+        return (PortType::idr() & MASK) ? PinState::High : PinState::Low;
+    }
+
+    /**
+     * @brief Check if pin is high
+     * @return true if pin is high
+     */
+    static bool isHigh() { return (PortType::idr() & MASK) != 0; }
+
+    /**
+     * @brief Check if pin is low
+     * @return true if pin is low
+     */
+    static bool isLow() { return (PortType::idr() & MASK) == 0; }
+
+    /**
+     * @brief Get runtime GPIO for the same pin
+     * @return GPIO object for configuration and runtime APIs
+     */
+    static GPIO toGpio() { return GPIO(PortType::base(), Pin); }
+};
+
+} // namespace hal
+} // namespace embedded
+
+#endif // HAL_GPIO_PIN_HPP
@@ -10,6 +10,10 @@
 #define HAL_I2C_HPP
 
 #include "types.hpp"
+#include "config.hpp"
+#include "dma.hpp"
+#include "system.hpp"
+#include "rtos.hpp"
 
 namespace embedded {
 namespace hal {
@@ -20,6 +24,11 @@ namespace hal {
  * 
  * Provides a portable interface for I2C master
  * communication with support for various speeds.
+ * 
+ * Blocking transfers run on the same interrupt-driven state machine as
+ * the *Async() calls and wait on a Semaphore given at completion, so
+ * the caller sleeps for up to the timeout instead of polling flags;
+ * with USE_RTOS the calling task blocks and other tasks run meanwhile.
  */
 class I2C {
 public:
@@ -48,8 +57,17 @@ public:
         AddressMode addressMode = AddressMode::SevenBit;
         bool        analogFilter = true;
         u8          digitalFilter = 0;  ///< 0-15
+        IrqPriority irqPriority = IrqPriority::Low;     ///< Event, error and DMA interrupts
     };
 
+    /**
+     * @brief Callback function type for asynchronous completion
+     * @param status Status::Ok, Status::NotFound on address NACK,
+     *               Status::HwError on bus/arbitration error
+     * @param context User context
+     */
+    using Callback = void (*)(Status status, void* context);
+
     /**
      * @brief Constructor
      * @param instance I2C peripheral instance
@@ -63,6 +81,10 @@ public:
 
     /**
      * @brief Initialize I2C with configuration
+     * 
+     * Registers for System clock profile changes; the bus timings are
+     * recomputed from the new APB1 clock on every switch.
+     * 
      * @param config I2C configuration
      * @return Status::Ok on success
      */
@@ -74,6 +96,12 @@ public:
      */
     Status deinit();
 
+    /**
+     * @brief Get active configuration
+     * @return Configuration passed to init()
+     */
+    const Config& getConfig() const;
+
     /**
      * @brief Write data to device
      * @param deviceAddr 7-bit device address
@@ -136,6 +164,57 @@ public:
      */
     Status readRegister(u8 deviceAddr, u8 regAddr, u8* data, u32 timeout = I2C_TIMEOUT_MS);
 
+    /**
+     * @brief Write to register (non-blocking)
+     * 
+     * Runs START, address, register and payload from the event
+     * interrupt; payloads of I2C_DMA_THRESHOLD bytes or more go over DMA.
+     * 
+     * @param deviceAddr 7-bit device address
+     * @param regAddr Register address
+     * @param data Pointer to data buffer (must stay valid until completion)
+     * @param length Number of bytes to write
+     * @param callback Completion callback (called from interrupt context)
+     * @param context User context
+     * @return Status::Ok if started, Status::Busy if a transfer is in flight
+     */
+    Status writeRegisterAsync(u8 deviceAddr, u8 regAddr, const u8* data, size_t length,
+                              Callback callback, void* context = nullptr);
+
+    /**
+     * @brief Read from register (non-blocking)
+     * 
+     * The register write, repeated START and read phase are sequenced
+     * entirely by the interrupt handlers; the caller is only notified
+     * once the last byte has been received and STOP issued. Reads of
+     * I2C_DMA_THRESHOLD bytes or more use DMA with hardware NACK (LAST).
+     * 
+     * @param deviceAddr 7-bit device address
+     * @param regAddr Register address
+     * @param data Pointer to receive buffer (must stay valid until completion)
+     * @param length Number of bytes to read
+     * @param callback Completion callback (called from interrupt context)
+     * @param context User context
+     * @return Status::Ok if started, Status::Busy if a transfer is in flight
+     */
+    Status readRegisterAsync(u8 deviceAddr, u8 regAddr, u8* data, size_t length,
+                             Callback callback, void* context = nullptr);
+
+    /**
+     * @brief Event interrupt handler
+     * 
+     * Call from the I2Cx_EV interrupt. Advances the transfer state machine.
+     */
+    void handleEventInterrupt();
+
+    /**
+     * @brief Error interrupt handler
+     * 
+     * Call from the I2Cx_ER interrupt. Aborts the transfer, issues STOP
+     * and reports the error through the completion callback.
+     */
+    void handleErrorInterrupt();
+
     /**
      * @brief Scan bus for devices
      * @param addresses Array to store found addresses
@@ -159,17 +238,72 @@ public:
 
     /**
      * @brief Check if bus is busy
-     * @return true if bus is busy
+     * @return true if bus is busy or an async transfer is in flight
      */
     bool isBusy() const;
 
 private:
+    /**
+     * @brief Asynchronous transfer states
+     */
+    enum class State : u8 {
+        Idle,
+        Start,          ///< START issued, waiting for SB
+        Address,        ///< Write address sent, waiting for ADDR
+        Register,       ///< Register byte sent, waiting for TXE/BTF
+        WriteData,      ///< Transmitting payload
+        RepeatedStart,  ///< Re-START issued for the read phase
+        ReadAddress,    ///< Read address sent, waiting for ADDR
+        ReadData,       ///< Receiving payload
+        Dma             ///< Payload handed to DMA
+    };
+
     void*   m_instance;
     Config  m_config;
+
+    volatile State m_state;
+    u8      m_deviceAddr;
+    u8      m_regAddr;
+    const u8* m_txData;
+    u8*     m_rxData;
+    size_t  m_length;
+    volatile size_t m_remaining;
+    bool    m_read;
+    Callback m_callback;
+    void*   m_callbackContext;
+    Dma*    m_txDma;            ///< TX DMA stream
+    Dma*    m_rxDma;            ///< RX DMA stream
+    ClockListener m_clockListener;  ///< Registered by init()
+    Semaphore m_done;               ///< Given by onBlockingDone()
+    volatile Status m_blockingStatus;
     
     void enableClock();
     void configurePins();
     void configureTimings();
+    void configureInterrupts();
+    void finishAsync(Status status);
+
+    /**
+     * @brief TX/RX DMA event callback
+     */
+    static void onDmaEvent(u32 events, void* context);
+
+    /**
+     * @brief Completion callback of blocking transfers
+     * 
+     * Stores the status and gives m_done. A transfer that timed out is
+     * stopped first, so a late completion cannot give the semaphore of
+     * the next one.
+     */
+    static void onBlockingDone(Status status, void* context);
+
+    /**
+     * @brief Clock profile change callback
+     * 
+     * Reruns configureTimings() (FREQ, CCR, TRISE) with the peripheral
+     * briefly disabled.
+     */
+    static void onClockChange(void* context);
     
     Status waitForFlag(u32 flag, bool state, u32 timeout);
     Status startCondition(u8 deviceAddr, bool read);
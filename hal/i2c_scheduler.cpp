@@ -0,0 +1,192 @@
+/**
+ * @file i2c_scheduler.cpp
+ * @brief Periodic I2C register polling implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "i2c_scheduler.hpp"
+#include "system.hpp"
+
+#include <cstring>
+
+namespace embedded {
+namespace hal {
+
+namespace {
+
+bool isDue(const I2CScheduler::Job* job, u64 now) {
+    return now >= job->nextDue;
+}
+
+} // namespace
+
+I2CScheduler::I2CScheduler(I2C* i2c)
+    : m_i2c(i2c)
+    , m_jobs(nullptr)
+    , m_running(false)
+    , m_burst()
+    , m_burstCount(0)
+    , m_burstDevice(0)
+    , m_burstReg(0)
+    , m_burstBuffer() {
+}
+
+Status I2CScheduler::addJob(Job* job) {
+    if (job == nullptr || job->data == nullptr || job->length == 0 ||
+        job->periodMs == 0 || job->length > I2C_SCHEDULER_BURST_SIZE ||
+        static_cast<u32>(job->regAddr) + job->length > 0x100) {
+        return Status::InvalidArg;
+    }
+
+    job->nextDue = System::getTicks64();
+    job->inBurst = false;
+
+    CriticalSection cs(m_i2c->getConfig().irqPriority);
+    job->next = m_jobs;
+    m_jobs = job;
+
+    return Status::Ok;
+}
+
+Status I2CScheduler::removeJob(Job* job) {
+    CriticalSection cs(m_i2c->getConfig().irqPriority);
+
+    if (job->inBurst) {
+        return Status::Busy;
+    }
+
+    for (Job** link = &m_jobs; *link != nullptr; link = &(*link)->next) {
+        if (*link == job) {
+            *link = job->next;
+            job->next = nullptr;
+            return Status::Ok;
+        }
+    }
+
+    return Status::NotFound;
+}
+
+void I2CScheduler::service() {
+    {
+        CriticalSection cs(m_i2c->getConfig().irqPriority);
+        if (m_running) {
+            return;
+        }
+        m_running = true;
+    }
+
+    if (!startBurst(System::getTicks64())) {
+        m_running = false;
+    }
+}
+
+bool I2CScheduler::startBurst(u64 now) {
+    Job* first = m_jobs;
+    while (first != nullptr && !isDue(first, now)) {
+        first = first->next;
+    }
+    if (first == nullptr) {
+        return false;
+    }
+
+    collectBurst(first, now);
+
+    u8 span = 0;
+    for (u8 i = 0; i < m_burstCount; i++) {
+        u8 end = static_cast<u8>(m_burst[i]->regAddr - m_burstReg + m_burst[i]->length);
+        if (end > span) {
+            span = end;
+        }
+    }
+
+    if (m_i2c->readRegisterAsync(m_burstDevice, m_burstReg, m_burstBuffer, span,
+                                 onBurstComplete, this) != Status::Ok) {
+        for (u8 i = 0; i < m_burstCount; i++) {
+            m_burst[i]->inBurst = false;
+        }
+        m_burstCount = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void I2CScheduler::collectBurst(Job* first, u64 now) {
+    m_burst[0] = first;
+    m_burstCount = 1;
+    m_burstDevice = first->deviceAddr;
+    first->inBurst = true;
+
+    u32 start = first->regAddr;
+    u32 end = start + first->length;
+
+    // Grow the register window until no other due job touches it
+    bool grown = true;
+    while (grown && m_burstCount < I2C_SCHEDULER_MAX_MERGE) {
+        grown = false;
+        for (Job* job = m_jobs; job != nullptr; job = job->next) {
+            if (job->inBurst || job->deviceAddr != m_burstDevice || !isDue(job, now)) {
+                continue;
+            }
+
+            u32 jobStart = job->regAddr;
+            u32 jobEnd = jobStart + job->length;
+            if (jobStart > end || jobEnd < start) {
+                continue;
+            }
+
+            u32 newStart = (jobStart < start) ? jobStart : start;
+            u32 newEnd = (jobEnd > end) ? jobEnd : end;
+            if (newEnd - newStart > I2C_SCHEDULER_BURST_SIZE) {
+                continue;
+            }
+
+            start = newStart;
+            end = newEnd;
+            job->inBurst = true;
+            m_burst[m_burstCount++] = job;
+            grown = true;
+
+            if (m_burstCount == I2C_SCHEDULER_MAX_MERGE) {
+                break;
+            }
+        }
+    }
+
+    m_burstReg = static_cast<u8>(start);
+}
+
+void I2CScheduler::onBurstComplete(Status status, void* context) {
+    I2CScheduler* self = static_cast<I2CScheduler*>(context);
+    u64 now = System::getTicks64();
+
+    for (u8 i = 0; i < self->m_burstCount; i++) {
+        Job* job = self->m_burst[i];
+
+        if (status == Status::Ok) {
+            std::memcpy(job->data, &self->m_burstBuffer[job->regAddr - self->m_burstReg], job->length);
+        }
+
+        // Keep the phase, but skip periods that were missed entirely
+        job->nextDue += job->periodMs;
+        if (isDue(job, now)) {
+            job->nextDue += ((now - job->nextDue) / job->periodMs + 1) * job->periodMs;
+        }
+        job->inBurst = false;
+
+        if (job->callback != nullptr) {
+            job->callback(status, job->context);
+        }
+    }
+    self->m_burstCount = 0;
+
+    // Chain the next due burst without returning to the main loop
+    if (!self->startBurst(now)) {
+        self->m_running = false;
+    }
+}
+
+} // namespace hal
+} // namespace embedded
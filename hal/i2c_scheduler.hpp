@@ -0,0 +1,117 @@
+/**
+ * @file i2c_scheduler.hpp
+ * @brief Periodic I2C register polling over the async I2C engine
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef HAL_I2C_SCHEDULER_HPP
+#define HAL_I2C_SCHEDULER_HPP
+
+#include "types.hpp"
+#include "config.hpp"
+#include "i2c.hpp"
+
+namespace embedded {
+namespace hal {
+
+/**
+ * @class I2CScheduler
+ * @brief Runs registered register-read jobs at their own rates
+ * 
+ * Jobs are registered once and then executed over
+ * I2C::readRegisterAsync(). Due jobs on the same device whose register
+ * ranges touch or overlap are merged into a single burst read, and
+ * bursts are chained from the completion interrupt until nothing is
+ * due, so the main loop only has to call service() once per tick.
+ */
+class I2CScheduler {
+public:
+    /**
+     * @brief Callback function type for job completion
+     * @param status Result of the burst that carried this job
+     * @param context User context
+     */
+    using Callback = void (*)(Status status, void* context);
+
+    /**
+     * @brief Polling job
+     * 
+     * Storage is owned by the caller and must stay valid while the job
+     * is registered.
+     */
+    struct Job {
+        u8          deviceAddr = 0;     ///< 7-bit device address
+        u8          regAddr    = 0;     ///< First register
+        u8          length     = 0;     ///< Bytes to read (<= I2C_SCHEDULER_BURST_SIZE)
+        u32         periodMs   = 0;     ///< Polling period (non-zero)
+        u8*         data       = nullptr; ///< Destination buffer
+        Callback    callback   = nullptr; ///< Called from interrupt context
+        void*       context    = nullptr;
+
+        // Internal state
+        u64         nextDue    = 0;        ///< getTicks64() of the next run
+        bool        inBurst    = false;
+        Job*        next       = nullptr;
+    };
+
+    /**
+     * @brief Constructor
+     * @param i2c Initialized I2C master
+     */
+    explicit I2CScheduler(I2C* i2c);
+
+    /**
+     * @brief Destructor
+     */
+    ~I2CScheduler() = default;
+
+    /**
+     * @brief Register a job
+     * 
+     * The job is due immediately and then every periodMs.
+     * 
+     * @param job Job to register
+     * @return Status::Ok on success, Status::InvalidArg on a malformed job
+     *         (including periodMs 0)
+     */
+    Status addJob(Job* job);
+
+    /**
+     * @brief Unregister a job
+     * @param job Job to remove
+     * @return Status::Ok on success, Status::Busy if the job is in flight,
+     *         Status::NotFound if it is not registered
+     */
+    Status removeJob(Job* job);
+
+    /**
+     * @brief Start due jobs if the bus is idle
+     * 
+     * Call periodically (e.g. once per tick). Returns immediately; the
+     * bursts themselves run from interrupt context.
+     */
+    void service();
+
+private:
+    I2C*        m_i2c;
+    Job*        m_jobs;
+    volatile bool m_running;
+
+    Job*        m_burst[I2C_SCHEDULER_MAX_MERGE];
+    u8          m_burstCount;
+    u8          m_burstDevice;
+    u8          m_burstReg;
+    u8          m_burstBuffer[I2C_SCHEDULER_BURST_SIZE];
+
+    bool startBurst(u64 now);
+    void collectBurst(Job* first, u64 now);
+
+    static void onBurstComplete(Status status, void* context);
+};
+
+} // namespace hal
+} // namespace embedded
+
+#endif // HAL_I2C_SCHEDULER_HPP
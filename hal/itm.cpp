@@ -0,0 +1,160 @@
+/**
+ * @file itm.cpp
+ * @brief ITM stimulus ports over SWO implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "hal/itm.hpp"
+#include "system.hpp"
+
+namespace embedded {
+namespace hal {
+
+static_assert(ITM_PORT_LOG < 32 && ITM_PORT_PROFILE < 32 &&
+              ITM_PORT_DATA + ITM_DATA_CHANNELS <= 32, "ITM ports must be 0-31");
+
+namespace {
+
+// ITM registers
+volatile u32* const ITM_STIM  = reinterpret_cast<volatile u32*>(0xE0000000);
+volatile u32* const ITM_TER   = reinterpret_cast<volatile u32*>(0xE0000E00);
+volatile u32* const ITM_TPR   = reinterpret_cast<volatile u32*>(0xE0000E40);
+volatile u32* const ITM_TCR   = reinterpret_cast<volatile u32*>(0xE0000E80);
+volatile u32* const ITM_LAR   = reinterpret_cast<volatile u32*>(0xE0000FB0);
+
+constexpr u32 TCR_ITMENA      = (1 << 0);
+constexpr u32 TCR_SYNCENA     = (1 << 2);
+constexpr u32 TCR_BUSY        = (1 << 23);
+constexpr u32 TCR_TRACE_ID    = (1 << 16);  ///< ATB ID 1
+constexpr u32 STIM_READY      = (1 << 0);   ///< Read value: FIFO can take a packet
+
+// TPIU registers
+volatile u32* const TPIU_CSPSR = reinterpret_cast<volatile u32*>(0xE0040004);
+volatile u32* const TPIU_ACPR  = reinterpret_cast<volatile u32*>(0xE0040010);
+volatile u32* const TPIU_SPPR  = reinterpret_cast<volatile u32*>(0xE00400F0);
+volatile u32* const TPIU_FFCR  = reinterpret_cast<volatile u32*>(0xE0040304);
+
+constexpr u32 SPPR_NRZ        = 2;          ///< Asynchronous SWO, UART framing
+constexpr u32 FFCR_TRIGIN     = (1 << 8);   ///< Formatter off (bypass)
+
+// Debug control
+volatile u32* const DEMCR     = reinterpret_cast<volatile u32*>(0xE000EDFC);
+volatile u32* const DBGMCU_CR = reinterpret_cast<volatile u32*>(0xE0042004);
+
+constexpr u32 DEMCR_TRCENA    = (1 << 24);
+constexpr u32 DBGMCU_TRACE_IOEN = (1 << 5); ///< TRACE_MODE 00: asynchronous
+
+constexpr u32 PORT_MASK = BIT(ITM_PORT_LOG) | BIT(ITM_PORT_PROFILE) |
+                          (((1UL << ITM_DATA_CHANNELS) - 1) << ITM_PORT_DATA);
+
+u32             s_swoBaudRate;
+ClockListener   s_clockListener;
+
+// TRACECLKIN is HCLK: SWO rate = HCLK / (ACPR + 1)
+void setPrescaler(u32 clock) {
+    *TPIU_ACPR = (clock > s_swoBaudRate) ? (clock / s_swoBaudRate) - 1 : 0;
+}
+
+void onClockChange(void* context) {
+    UNUSED(context);
+    setPrescaler(System::getSystemClock());
+}
+
+} // namespace
+
+Status Itm::init(u32 swoBaudRate) {
+    u32 clock = System::getSystemClock();
+    if (swoBaudRate == 0 || swoBaudRate > clock) {
+        return Status::InvalidArg;
+    }
+
+    *DEMCR |= DEMCR_TRCENA;
+    *DBGMCU_CR |= DBGMCU_TRACE_IOEN;
+
+    s_swoBaudRate = swoBaudRate;
+    *TPIU_CSPSR = 1;
+    *TPIU_SPPR = SPPR_NRZ;
+    setPrescaler(clock);
+    *TPIU_FFCR = FFCR_TRIGIN;
+
+    s_clockListener.callback = onClockChange;
+    System::addClockListener(&s_clockListener);
+
+    *ITM_LAR = 0xC5ACCE55;
+    *ITM_TCR = 0;
+    while (*ITM_TCR & TCR_BUSY) {}
+
+    *ITM_TCR = TCR_TRACE_ID | TCR_SYNCENA | TCR_ITMENA;
+    *ITM_TPR = 0;
+    *ITM_TER = PORT_MASK;
+
+    return Status::Ok;
+}
+
+bool Itm::isEnabled(u8 port) {
+    return (*ITM_TCR & TCR_ITMENA) && (*ITM_TER & BIT(port));
+}
+
+bool Itm::writeWord(u8 port, u32 word) {
+    if (!isEnabled(port)) {
+        return false;
+    }
+
+    // The FIFO is shared by all ports: check and write without preemption
+    u32 primask = disableInterrupts();
+    bool ready = (ITM_STIM[port] & STIM_READY) != 0;
+    if (ready) {
+        ITM_STIM[port] = word;
+    }
+    restoreInterrupts(primask);
+
+    return ready;
+}
+
+bool Itm::writeByte(u8 port, u8 byte) {
+    if (!isEnabled(port)) {
+        return false;
+    }
+
+    volatile u8* stim = reinterpret_cast<volatile u8*>(&ITM_STIM[port]);
+
+    u32 primask = disableInterrupts();
+    bool ready = (ITM_STIM[port] & STIM_READY) != 0;
+    if (ready) {
+        *stim = byte;
+    }
+    restoreInterrupts(primask);
+
+    return ready;
+}
+
+size_t Itm::write(u8 port, const u8* data, size_t length) {
+    if (data == nullptr) {
+        return 0;
+    }
+
+    size_t sent = 0;
+    while (length - sent >= 4) {
+        u32 word = static_cast<u32>(data[sent]) |
+                   (static_cast<u32>(data[sent + 1]) << 8) |
+                   (static_cast<u32>(data[sent + 2]) << 16) |
+                   (static_cast<u32>(data[sent + 3]) << 24);
+        if (!writeWord(port, word)) {
+            return sent;
+        }
+        sent += 4;
+    }
+    while (sent < length) {
+        if (!writeByte(port, data[sent])) {
+            return sent;
+        }
+        sent++;
+    }
+
+    return sent;
+}
+
+} // namespace hal
+} // namespace embedded
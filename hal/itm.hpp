@@ -0,0 +1,108 @@
+/**
+ * @file itm.hpp
+ * @brief ITM stimulus ports over SWO
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef HAL_ITM_HPP
+#define HAL_ITM_HPP
+
+#include "types.hpp"
+#include "config.hpp"
+
+namespace embedded {
+namespace hal {
+
+/**
+ * @class Itm
+ * @brief Non-blocking trace output on the ITM stimulus ports
+ *
+ * Each stimulus port is an independent byte channel multiplexed onto
+ * the single-wire SWO pin (PB3, AF0 after reset) by the TPIU in NRZ
+ * mode. The probe (OpenOCD, J-Link SWO Viewer, orbuculum) demultiplexes
+ * them again. Port assignment comes from config.hpp:
+ *
+ *   ITM_PORT_LOG       Binary log frames (Log::process())
+ *   ITM_PORT_PROFILE   Profiler events, one word per handler exit
+ *   ITM_PORT_DATA      First of ITM_DATA_CHANNELS sample channels
+ *
+ * Writes never wait: a write that finds the ITM FIFO busy returns
+ * false (or a short count) and the caller retries or drops. Writes
+ * to a disabled port (no init(), or a debugger turned it off) are
+ * discarded, so trace calls cost a register read when nobody listens.
+ *
+ * Word and byte writes are safe from any context; a multi-byte stream
+ * on one port must have a single writer.
+ */
+class Itm {
+public:
+    /**
+     * @brief Set up the TPIU for SWO and enable the configured ports
+     *
+     * Debuggers that configure SWO themselves may overwrite these
+     * settings; writes follow whatever the port enables say. The SWO
+     * prescaler follows System::setClockProfile() switches (the probe
+     * may lose sync if the new HCLK is not a multiple of the rate).
+     *
+     * @param swoBaudRate SWO bit rate (the probe must match)
+     * @return Status::Ok, or Status::InvalidArg if the rate cannot be
+     *         derived from the core clock
+     */
+    static Status init(u32 swoBaudRate = ITM_SWO_BAUDRATE);
+
+    /**
+     * @brief Check whether a stimulus port is enabled
+     * @param port Stimulus port (0-31)
+     * @return true if writes to the port reach the SWO output
+     */
+    static bool isEnabled(u8 port);
+
+    /**
+     * @brief Write one 32-bit packet
+     * @param port Stimulus port (0-31)
+     * @param word Value, sent little endian
+     * @return true if the packet was accepted
+     */
+    static bool writeWord(u8 port, u32 word);
+
+    /**
+     * @brief Write one 8-bit packet
+     * @param port Stimulus port (0-31)
+     * @param byte Value
+     * @return true if the packet was accepted
+     */
+    static bool writeByte(u8 port, u8 byte);
+
+    /**
+     * @brief Write a byte stream, as much as the FIFO accepts
+     *
+     * Sends whole words where possible and the tail byte-wise.
+     *
+     * @param port Stimulus port (0-31)
+     * @param data Bytes to send
+     * @param length Number of bytes
+     * @return Number of bytes accepted (less than length when the FIFO
+     *         filled up; 0 if the port is disabled)
+     */
+    static size_t write(u8 port, const u8* data, size_t length);
+
+    /**
+     * @brief Send a sample on a data channel
+     * @param channel Channel (0 .. ITM_DATA_CHANNELS - 1)
+     * @param value Sample value
+     * @return true if the sample was accepted
+     */
+    static bool sample(u8 channel, u32 value) {
+        if (channel >= ITM_DATA_CHANNELS) {
+            return false;
+        }
+        return writeWord(static_cast<u8>(ITM_PORT_DATA + channel), value);
+    }
+};
+
+} // namespace hal
+} // namespace embedded
+
+#endif // HAL_ITM_HPP
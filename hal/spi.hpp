@@ -11,6 +11,8 @@
 
 #include "types.hpp"
 #include "gpio.hpp"
+#include "dma.hpp"
+#include "system.hpp"
 
 namespace embedded {
 namespace hal {
@@ -75,8 +77,16 @@ public:
         BitOrder        bitOrder    = BitOrder::MSBFirst;
         u32             clockHz     = 1000000;  ///< SPI clock frequency
         bool            softwareCS  = true;     ///< Software-managed chip select
+        IrqPriority     irqPriority = IrqPriority::Medium;  ///< SPI and DMA stream interrupts
     };
 
+    /**
+     * @brief Callback function type for asynchronous transfer completion
+     * @param status Status::Ok, or Status::HwError on DMA/overrun error
+     * @param context User context
+     */
+    using TransferCallback = void (*)(Status status, void* context);
+
     /**
      * @brief Constructor
      * @param instance SPI peripheral instance
@@ -90,6 +100,10 @@ public:
 
     /**
      * @brief Initialize SPI with configuration
+     * 
+     * Registers for System clock profile changes; the baud prescaler is
+     * recomputed for Config::clockHz on every switch.
+     * 
      * @param config SPI configuration
      * @return Status::Ok on success
      */
@@ -101,6 +115,24 @@ public:
      */
     Status deinit();
 
+    /**
+     * @brief Apply a new frame format and clock to an initialized bus
+     * 
+     * Reprograms CR1 only (CPOL/CPHA, data size, bit order, prescaler)
+     * without resetting the peripheral or reconfiguring pins and DMA.
+     * The bus must be idle.
+     * 
+     * @param config SPI configuration
+     * @return Status::Ok on success, Status::Busy if a transfer is in flight
+     */
+    Status reconfigure(const Config& config);
+
+    /**
+     * @brief Get active configuration
+     * @return Reference to the configuration currently programmed
+     */
+    const Config& getConfig() const;
+
     /**
      * @brief Transfer single byte
      * @param txData Byte to transmit
@@ -140,6 +172,36 @@ public:
      */
     Status receive(u8* data, size_t length);
 
+    /**
+     * @brief Start full-duplex DMA transfer (non-blocking)
+     * 
+     * Asserts chip select, runs the transfer over the TX/RX DMA streams
+     * and deasserts chip select from the completion interrupt before the
+     * callback is invoked. Transfers longer than 65535 bytes are split
+     * into chained DMA blocks without releasing chip select.
+     * 
+     * @param txData Transmit buffer (nullptr sends 0xFF)
+     * @param rxData Receive buffer (nullptr discards received data)
+     * @param length Number of bytes to transfer
+     * @param callback Completion callback (called from interrupt context,
+     *                 may start the next transfer)
+     * @param context User context
+     * @return Status::Ok if started, Status::Busy if a transfer is in flight
+     */
+    Status transferAsync(const u8* txData, u8* rxData, size_t length,
+                         TransferCallback callback = nullptr, void* context = nullptr);
+
+    /**
+     * @brief Start transmit-only DMA transfer (non-blocking)
+     * @param data Transmit buffer
+     * @param length Number of bytes to transmit
+     * @param callback Completion callback (called from interrupt context)
+     * @param context User context
+     * @return Status::Ok if started, Status::Busy if a transfer is in flight
+     */
+    Status transmitAsync(const u8* data, size_t length,
+                         TransferCallback callback = nullptr, void* context = nullptr);
+
     /**
      * @brief Set chip select pin
      * @param csPin Pointer to GPIO for chip select
@@ -165,7 +227,7 @@ public:
 
     /**
      * @brief Check if SPI is busy
-     * @return true if transfer in progress
+     * @return true if a blocking or DMA transfer is in progress
      */
     bool isBusy() const;
 
@@ -174,8 +236,37 @@ private:
     Config  m_config;
     GPIO*   m_csPin;
     
+    Dma*    m_txDma;                ///< TX DMA stream
+    Dma*    m_rxDma;                ///< RX DMA stream
+    volatile bool m_asyncActive;
+    const u8* m_asyncTx;            ///< Next TX block (nullptr = dummy bytes)
+    u8*     m_asyncRx;              ///< Next RX block (nullptr = discard)
+    size_t  m_asyncRemaining;       ///< Bytes not yet handed to DMA
+    TransferCallback m_callback;
+    void*   m_callbackContext;
+    u8      m_dummy;                ///< Fill/sink byte for one-sided transfers
+    ClockListener m_clockListener;  ///< Registered by init()
+    
     void enableClock();
     void configurePins();
+    Status configureDma();
+    void startDmaBlock();
+
+    /**
+     * @brief DMA event callback
+     * 
+     * Registered on the RX stream (TX stream for transmit-only
+     * transfers). Starts the next block or finishes the transfer.
+     */
+    static void onDmaEvent(u32 events, void* context);
+
+    /**
+     * @brief Clock profile change callback
+     * 
+     * Picks the prescaler closest to (not above) Config::clockHz at the
+     * new APB clock.
+     */
+    static void onClockChange(void* context);
     u8 calculatePrescaler(u32 clockHz);
 };
 
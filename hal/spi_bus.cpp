@@ -0,0 +1,120 @@
+/**
+ * @file spi_bus.cpp
+ * @brief Queued SPI transactions implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "spi_bus.hpp"
+
+namespace embedded {
+namespace hal {
+
+namespace {
+
+bool sameSettings(const SPI::Config& a, const SPI::Config& b) {
+    return a.mode == b.mode &&
+           a.cpol == b.cpol &&
+           a.cpha == b.cpha &&
+           a.dataSize == b.dataSize &&
+           a.bitOrder == b.bitOrder &&
+           a.clockHz == b.clockHz;
+}
+
+void complete(SpiBus::Transaction* t, Status status) {
+    if (t != nullptr && t->callback != nullptr) {
+        t->callback(status, t->context);
+    }
+}
+
+} // namespace
+
+SpiBus::SpiBus(SPI* spi)
+    : m_spi(spi)
+    , m_queue()
+    , m_running(false)
+    , m_activeDevice(nullptr) {
+}
+
+Status SpiBus::submit(Transaction* transaction) {
+    if (transaction == nullptr || transaction->device == nullptr || transaction->length == 0) {
+        return Status::InvalidArg;
+    }
+
+    if (!m_queue.push(transaction)) {
+        return Status::NoMemory;
+    }
+
+    // The completion interrupt keeps the queue moving once it is started
+    if (claim()) {
+        startNext(nullptr, Status::Ok);
+    }
+
+    return Status::Ok;
+}
+
+bool SpiBus::isIdle() const {
+    return m_queue.empty();
+}
+
+bool SpiBus::claim() {
+    return !__atomic_exchange_n(&m_running, true, __ATOMIC_ACQ_REL);
+}
+
+void SpiBus::startNext(Transaction* done, Status doneStatus) {
+    Transaction* t;
+    while (m_queue.peek(t)) {
+        applyDevice(t->device);
+        m_spi->setChipSelect(t->device->csPin);
+
+        if (m_spi->transferAsync(t->txData, t->rxData, t->length,
+                                 onTransferComplete, this) == Status::Ok) {
+            complete(done, doneStatus);
+            return;
+        }
+
+        // Could not start: fail this transaction and move on, after the
+        // one that just completed so callbacks keep submission order
+        m_queue.consume(1);
+        complete(done, doneStatus);
+        done = nullptr;
+        complete(t, Status::Error);
+    }
+
+    complete(done, doneStatus);
+
+    // Release the bus, then re-check for a submit that raced with us
+    __atomic_store_n(&m_running, false, __ATOMIC_RELEASE);
+    if (!m_queue.empty() && claim()) {
+        startNext(nullptr, Status::Ok);
+    }
+}
+
+void SpiBus::applyDevice(const Device* device) {
+    if (device == m_activeDevice) {
+        return;
+    }
+
+    // Devices often share settings; only touch CR1 when they differ
+    if (!sameSettings(m_spi->getConfig(), device->config)) {
+        m_spi->reconfigure(device->config);
+    }
+    m_activeDevice = device;
+}
+
+void SpiBus::onTransferComplete(Status status, void* context) {
+    SpiBus* bus = static_cast<SpiBus*>(context);
+
+    Transaction* done = nullptr;
+    if (!bus->m_queue.pop(done)) {
+        return;
+    }
+
+    // Restart the bus before running user code to keep it saturated;
+    // startNext() runs the callback of done
+    bus->startNext(done, status);
+}
+
+} // namespace hal
+} // namespace embedded
@@ -0,0 +1,119 @@
+/**
+ * @file spi_bus.hpp
+ * @brief Queued SPI transactions for devices sharing one bus
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef HAL_SPI_BUS_HPP
+#define HAL_SPI_BUS_HPP
+
+#include "types.hpp"
+#include "config.hpp"
+#include "ring_buffer.hpp"
+#include "spi.hpp"
+
+namespace embedded {
+namespace hal {
+
+/**
+ * @class SpiBus
+ * @brief Transaction queue arbitrating several devices on one SPI
+ * 
+ * Each device carries its own frame format, clock and chip select.
+ * Submitted transactions run back to back over SPI::transferAsync();
+ * the next one is started from the DMA-complete interrupt of the
+ * previous one, and CR1 is only reprogrammed when consecutive
+ * transactions target devices with different settings. Callbacks run
+ * in submission order, including Status::Error for transactions that
+ * could not be started.
+ * 
+ * The queue is a lock-free SPSC ring: submit() (one producer context)
+ * and the completion interrupt never mask interrupts.
+ */
+class SpiBus {
+public:
+    /**
+     * @brief Device on the bus
+     */
+    struct Device {
+        SPI::Config config;             ///< CPOL/CPHA, data size, bit order, clock
+        GPIO*       csPin = nullptr;    ///< Chip select (active low)
+    };
+
+    /**
+     * @brief Callback function type for transaction completion
+     */
+    using Callback = SPI::TransferCallback;
+
+    /**
+     * @brief Queued transaction
+     * 
+     * Storage is owned by the caller and must stay valid until the
+     * callback has run.
+     */
+    struct Transaction {
+        Device*     device   = nullptr;
+        const u8*   txData   = nullptr; ///< Transmit buffer (nullptr sends 0xFF)
+        u8*         rxData   = nullptr; ///< Receive buffer (nullptr discards)
+        size_t      length   = 0;
+        Callback    callback = nullptr; ///< Called from interrupt context
+        void*       context  = nullptr;
+    };
+
+    /**
+     * @brief Constructor
+     * @param spi Initialized SPI master to arbitrate
+     */
+    explicit SpiBus(SPI* spi);
+
+    /**
+     * @brief Destructor
+     */
+    ~SpiBus() = default;
+
+    /**
+     * @brief Queue a transaction
+     * 
+     * Starts it immediately if the bus is idle. Must always be called
+     * from the same context (the single producer of the queue).
+     * 
+     * @param transaction Transaction to queue
+     * @return Status::Ok on success, Status::InvalidArg on a malformed
+     *         request, Status::NoMemory if SPI_BUS_QUEUE_DEPTH is reached
+     */
+    Status submit(Transaction* transaction);
+
+    /**
+     * @brief Check if the queue is drained
+     * @return true if no transaction is queued or in flight
+     */
+    bool isIdle() const;
+
+private:
+    SPI*                m_spi;
+    RingBuffer<Transaction*, SPI_BUS_QUEUE_DEPTH> m_queue;  ///< Front is in flight
+    bool                m_running;      ///< Owned by whoever claimed the bus
+    const Device*       m_activeDevice; ///< Device whose settings are in CR1
+
+    bool claim();
+
+    /**
+     * @brief Start the next queued transaction
+     * @param done Transaction that just completed (nullptr if none)
+     * @param doneStatus Status reported to done's callback
+     *
+     * done's callback runs once the next transfer is started, and before
+     * the callbacks of any transactions that fail to start.
+     */
+    void startNext(Transaction* done, Status doneStatus);
+    void applyDevice(const Device* device);
+
+    static void onTransferComplete(Status status, void* context);
+};
+
+} // namespace hal
+} // namespace embedded
+
+#endif // HAL_SPI_BUS_HPP
@@ -0,0 +1,356 @@
+/**
+ * @file timer.hpp
+ * @brief Hardware timer Hardware Abstraction Layer
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef HAL_TIMER_HPP
+#define HAL_TIMER_HPP
+
+#include "types.hpp"
+#include "dma.hpp"
+#include "system.hpp"
+
+namespace embedded {
+namespace hal {
+
+/**
+ * @class Timer
+ * @brief General-purpose and advanced timer abstraction (TIM1-TIM14)
+ *
+ * Provides time base, PWM output, input capture and one-pulse
+ * operation. Compare registers can be streamed by DMA burst (DMAR), so
+ * waveforms run without CPU involvement after setup.
+ *
+ * All times are in timer ticks of Config::tickHz; the prescaler is
+ * derived from the timer input clock (APB clock x2 when the APB
+ * prescaler is not 1) and recomputed when System::setClockProfile()
+ * changes that clock.
+ */
+class Timer {
+public:
+    /**
+     * @brief Counter mode
+     */
+    enum class CountMode : u8 {
+        Up              = 0,    ///< Count up to period, then restart at 0
+        Down            = 1,    ///< Count down from period to 0
+        CenterAligned1  = 2,    ///< Up/down, compare flags while counting down
+        CenterAligned2  = 3,    ///< Up/down, compare flags while counting up
+        CenterAligned3  = 4     ///< Up/down, compare flags both ways
+    };
+
+    /**
+     * @brief Capture/compare channel
+     */
+    enum class Channel : u8 {
+        Ch1 = 0,
+        Ch2 = 1,
+        Ch3 = 2,
+        Ch4 = 3
+    };
+
+    /**
+     * @brief PWM output mode
+     */
+    enum class PwmMode : u8 {
+        Pwm1 = 0,   ///< Active while counter < compare
+        Pwm2 = 1    ///< Inactive while counter < compare
+    };
+
+    /**
+     * @brief Output polarity
+     */
+    enum class Polarity : u8 {
+        ActiveHigh = 0,
+        ActiveLow  = 1
+    };
+
+    /**
+     * @brief Input capture edge
+     */
+    enum class CaptureEdge : u8 {
+        Rising  = 0,
+        Falling = 1,
+        Both    = 2
+    };
+
+    /**
+     * @brief Trigger output (TRGO) source for other peripherals
+     */
+    enum class TriggerOutput : u8 {
+        Reset        = 0,   ///< UG bit
+        Enable       = 1,   ///< Counter enable
+        Update       = 2,   ///< Update event (e.g. ADC sample clock)
+        ComparePulse = 3,
+        Oc1Ref       = 4,
+        Oc2Ref       = 5,
+        Oc3Ref       = 6,
+        Oc4Ref       = 7
+    };
+
+    /**
+     * @brief Timer time base configuration
+     */
+    struct Config {
+        u32         tickHz      = 1000000;      ///< Counter clock after prescaler
+        u32         period      = 1000;         ///< Auto-reload value + 1 (ticks)
+        CountMode   countMode   = CountMode::Up;
+        u8          repetition  = 0;            ///< Update every N+1 periods (TIM1/TIM8)
+        bool        preload     = true;         ///< Buffer period changes until update
+        IrqPriority irqPriority = IrqPriority::Medium;  ///< Timer and DMA stream interrupts
+    };
+
+    /**
+     * @brief PWM channel configuration
+     */
+    struct PwmConfig {
+        PwmMode     mode        = PwmMode::Pwm1;
+        Polarity    polarity    = Polarity::ActiveHigh;
+        u32         pulse       = 0;            ///< Initial compare value (ticks)
+        bool        preload     = true;         ///< Apply compare changes on update
+    };
+
+    /**
+     * @brief Input capture channel configuration
+     */
+    struct CaptureConfig {
+        CaptureEdge edge        = CaptureEdge::Rising;
+        u8          prescaler   = 0;            ///< Capture every 1, 2, 4 or 8 edges (0-3)
+        u8          filter      = 0;            ///< Input filter (0-15)
+    };
+
+    /**
+     * @brief Callback function type for update/overflow events
+     */
+    using Callback = void (*)(void* context);
+
+    /**
+     * @brief Callback function type for input capture
+     * @param channel Channel that captured
+     * @param value Captured counter value
+     * @param context User context
+     */
+    using CaptureCallback = void (*)(Channel channel, u32 value, void* context);
+
+    /**
+     * @brief Constructor
+     * @param instance Timer peripheral instance
+     */
+    explicit Timer(void* instance);
+
+    /**
+     * @brief Destructor
+     */
+    ~Timer();
+
+    /**
+     * @brief Initialize timer time base
+     * @param config Timer configuration
+     * @return Status::Ok on success, Status::InvalidArg if tickHz or
+     *         period cannot be reached (16-bit timers: period <= 65536)
+     */
+    Status init(const Config& config);
+
+    /**
+     * @brief Deinitialize timer
+     * @return Status::Ok on success
+     */
+    Status deinit();
+
+    /**
+     * @brief Start counting
+     */
+    void start();
+
+    /**
+     * @brief Stop counting
+     */
+    void stop();
+
+    /**
+     * @brief Change the period
+     * @param period New period in ticks (applied on next update if preload)
+     * @return Status::Ok on success
+     */
+    Status setPeriod(u32 period);
+
+    /**
+     * @brief Get the period
+     * @return Period in ticks
+     */
+    u32 getPeriod() const;
+
+    /**
+     * @brief Get counter value
+     * @return Current counter value
+     */
+    u32 getCounter() const;
+
+    /**
+     * @brief Set counter value
+     * @param value New counter value
+     */
+    void setCounter(u32 value);
+
+    /**
+     * @brief Select the trigger output (master mode)
+     * @param source TRGO source
+     */
+    void setTriggerOutput(TriggerOutput source);
+
+    /**
+     * @brief Set update (overflow) callback
+     * @param callback Callback function (nullptr disables the interrupt)
+     * @param context User context passed to callback
+     */
+    void setUpdateCallback(Callback callback, void* context = nullptr);
+
+    /**
+     * @brief Configure a channel for PWM output
+     * @param channel Output channel
+     * @param config PWM configuration
+     * @return Status::Ok on success
+     */
+    Status configurePwm(Channel channel, const PwmConfig& config);
+
+    /**
+     * @brief Set compare value (PWM pulse width)
+     * @param channel Channel
+     * @param value Compare value in ticks
+     */
+    void setCompare(Channel channel, u32 value);
+
+    /**
+     * @brief Get compare value
+     * @param channel Channel
+     * @return Compare value in ticks
+     */
+    u32 getCompare(Channel channel) const;
+
+    /**
+     * @brief Enable channel output or capture
+     * @param channel Channel
+     */
+    void enableChannel(Channel channel);
+
+    /**
+     * @brief Disable channel output or capture
+     * @param channel Channel
+     */
+    void disableChannel(Channel channel);
+
+    /**
+     * @brief Configure a channel for input capture
+     * @param channel Input channel
+     * @param config Capture configuration
+     * @param callback Callback on each capture (nullptr for polling)
+     * @param context User context passed to callback
+     * @return Status::Ok on success
+     */
+    Status configureCapture(Channel channel, const CaptureConfig& config,
+                            CaptureCallback callback = nullptr, void* context = nullptr);
+
+    /**
+     * @brief Get last captured value
+     * @param channel Input channel
+     * @return Captured counter value
+     */
+    u32 getCapture(Channel channel) const;
+
+    /**
+     * @brief Emit a single pulse (one-pulse mode)
+     *
+     * The channel output goes active @p delay ticks after the call and
+     * stays active for @p width ticks; the counter then stops by itself.
+     * The channel must be configured with configurePwm() (Pwm2 mode).
+     *
+     * @param channel Output channel
+     * @param delay Ticks before the pulse (>= 1)
+     * @param width Pulse width in ticks
+     * @return Status::Ok on success, Status::Busy if the timer is running
+     */
+    Status startOnePulse(Channel channel, u32 delay, u32 width);
+
+    /**
+     * @brief Stream compare registers by DMA burst
+     *
+     * On every update event the DMA writes @p channelCount consecutive
+     * CCR registers starting at @p firstChannel through DMAR, taking the
+     * next values from @p data. With @p circular the table repeats
+     * forever, so a waveform or pattern runs with zero CPU load.
+     *
+     * @param data Compare values, channelCount per update (16-bit timers
+     *        use the low half-word)
+     * @param updates Number of update events in the table
+     * @param firstChannel First channel written per burst
+     * @param channelCount Channels per burst (1-4)
+     * @param circular Repeat the table
+     * @param callback Called after the last update (non-circular only)
+     * @param context User context passed to callback
+     * @return Status::Ok on success, Status::Busy if a burst is active,
+     *         Status::NotReady without a DMA stream for this timer
+     */
+    Status startBurstDma(const u32* data, size_t updates, Channel firstChannel,
+                         u8 channelCount, bool circular,
+                         Callback callback = nullptr, void* context = nullptr);
+
+    /**
+     * @brief Stop a DMA burst
+     */
+    void stopBurstDma();
+
+    /**
+     * @brief Timer interrupt handler
+     *
+     * Call from the timer's update/capture-compare vector.
+     */
+    void handleInterrupt();
+
+    /**
+     * @brief Get counter clock
+     * @return Tick frequency actually achieved in Hz
+     */
+    u32 getTickHz() const;
+
+private:
+    void*   m_instance;
+    Config  m_config;
+    u32     m_tickHz;
+
+    Callback        m_updateCallback;
+    void*           m_updateContext;
+    CaptureCallback m_captureCallback;
+    void*           m_captureContext;
+
+    Dma*    m_dma;                  ///< Update DMA stream (burst mode)
+    Callback m_burstCallback;
+    void*   m_burstContext;
+    volatile bool m_burstActive;
+    ClockListener m_clockListener;  ///< Registered by init()
+
+    void enableClock();
+    Status configureDma();
+    u32 getInputClock() const;
+
+    /**
+     * @brief Burst DMA transfer-complete callback
+     */
+    static void onBurstDma(u32 events, void* context);
+
+    /**
+     * @brief Clock profile change callback
+     * 
+     * Reprograms PSC for Config::tickHz at the new input clock; the
+     * period and compare values are kept.
+     */
+    static void onClockChange(void* context);
+    bool is32Bit() const;
+};
+
+} // namespace hal
+} // namespace embedded
+
+#endif // HAL_TIMER_HPP
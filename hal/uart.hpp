@@ -11,6 +11,11 @@
 
 #include "types.hpp"
 #include "config.hpp"
+#include "ring_buffer.hpp"
+#include "dma.hpp"
+#include "crc.hpp"
+#include "system.hpp"
+#include "rtos.hpp"
 
 namespace embedded {
 namespace hal {
@@ -69,6 +74,9 @@ public:
         Parity      parity      = Parity::None;
         StopBits    stopBits    = StopBits::One;
         FlowControl flowControl = FlowControl::None;
+        bool        txDma       = false;    ///< Queue transmit()/print() through the DMA TX ring
+        bool        rxCrc       = false;    ///< Fold DMA-received bytes into getRxCrc()
+        IrqPriority irqPriority = IrqPriority::Low;     ///< UART and DMA stream interrupts
     };
 
     /**
@@ -77,6 +85,15 @@ public:
     using RxCallback = void (*)(u8 data, void* context);
     using TxCallback = void (*)(void* context);
 
+    /**
+     * @brief Callback function type for DMA frame reception
+     * 
+     * @p data points directly into the DMA receive ring and stays valid
+     * until the ring wraps back over it; copy out anything that must
+     * outlive the callback.
+     */
+    using FrameCallback = void (*)(const u8* data, size_t length, void* context);
+
     /**
      * @brief Constructor
      * @param instance UART peripheral instance (e.g., USART1, USART2)
@@ -90,6 +107,10 @@ public:
 
     /**
      * @brief Initialize UART with configuration
+     * 
+     * Registers for System clock profile changes; the baud rate is
+     * recomputed from the new APB clock on every switch.
+     * 
      * @param config UART configuration
      * @return Status::Ok on success
      */
@@ -109,7 +130,11 @@ public:
     Status transmit(u8 data);
 
     /**
-     * @brief Transmit buffer (blocking)
+     * @brief Transmit buffer
+     * 
+     * Blocks until the last byte is shifted out, unless Config::txDma
+     * is set, in which case the data is queued via transmitDMA().
+     * 
      * @param data Pointer to data buffer
      * @param length Number of bytes to transmit
      * @return Status::Ok on success
@@ -117,7 +142,10 @@ public:
     Status transmit(const u8* data, size_t length);
 
     /**
-     * @brief Transmit string (blocking)
+     * @brief Transmit string
+     * 
+     * Blocking, or queued via transmitDMA() when Config::txDma is set.
+     * 
      * @param str Null-terminated string
      * @return Status::Ok on success
      */
@@ -125,6 +153,11 @@ public:
 
     /**
      * @brief Receive single byte (blocking)
+     * 
+     * Waits on a Semaphore given by the receive interrupt rather than
+     * polling the status register; with USE_RTOS the calling task
+     * blocks and other tasks run meanwhile.
+     * 
      * @param data Pointer to store received byte
      * @param timeout Timeout in milliseconds
      * @return Status::Ok on success, Status::Timeout on timeout
@@ -133,6 +166,9 @@ public:
 
     /**
      * @brief Receive buffer (blocking)
+     * 
+     * Waits as receive(u8*, u32) does; @p timeout covers the whole buffer.
+     * 
      * @param data Pointer to receive buffer
      * @param length Number of bytes to receive
      * @param timeout Timeout in milliseconds
@@ -154,6 +190,60 @@ public:
      */
     Status stopReceiveIT();
 
+    /**
+     * @brief Start circular DMA reception with idle-line detection
+     * 
+     * The receiver runs continuously into a UART_RX_DMA_BUFFER_SIZE ring.
+     * Data is delivered on USART IDLE and on DMA half/full-transfer
+     * events, so the CPU is interrupted per frame rather than per byte.
+     * A frame that straddles the end of the ring is delivered as two
+     * consecutive callbacks. Use startReceiveIT() for low-rate ports.
+     * Restarts the running receive CRC (see getRxCrc()).
+     * 
+     * @param callback Frame callback function
+     * @param context User context
+     * @return Status::Ok on success, Status::Busy if IT reception is active
+     */
+    Status startReceiveDMA(FrameCallback callback, void* context = nullptr);
+
+    /**
+     * @brief Stop circular DMA reception
+     * @return Status::Ok on success
+     */
+    Status stopReceiveDMA();
+
+    /**
+     * @brief Get the running CRC32 of DMA-received bytes
+     * 
+     * With Config::rxCrc set, every span is folded into a running
+     * Crc::crc32() (the hardware unit when it is free) right before it
+     * is handed to the FrameCallback, so inside the callback the value
+     * already covers the span being delivered and frames split at the
+     * ring wrap need no special handling. A frame that ends in the
+     * big-endian CRC-32/MPEG-2 of its payload leaves the value at 0
+     * after its last byte:
+     * 
+     *     if (uart.getRxCrc() == 0) { ... frame ok ... }
+     *     uart.resetRxCrc();
+     * 
+     * @return Running CRC since startReceiveDMA() or resetRxCrc()
+     */
+    u32 getRxCrc() const { return m_rxCrc; }
+
+    /**
+     * @brief Restart the running receive CRC at the start of a frame
+     */
+    void resetRxCrc() { m_rxCrc = Crc::CRC32_INIT; }
+
+    /**
+     * @brief RX DMA / idle-line event handler
+     * 
+     * Call from the USART interrupt (IDLE); the RX DMA stream's
+     * half/full-transfer events are routed here by hal::Dma. Delivers
+     * bytes written since the last event.
+     */
+    void handleRxEvent();
+
     /**
      * @brief Transmit buffer using interrupts
      * @param data Pointer to data buffer
@@ -164,6 +254,26 @@ public:
      */
     Status transmitIT(const u8* data, size_t length, TxCallback callback = nullptr, void* context = nullptr);
 
+    /**
+     * @brief Queue buffer for DMA transmission (non-blocking)
+     * 
+     * Copies the data into the TX ring and returns immediately. If the
+     * TX DMA stream is idle, a transfer is started over the contiguous
+     * part of the ring; a wrapped remainder is chained from the
+     * transfer-complete interrupt.
+     * 
+     * @param data Pointer to data buffer
+     * @param length Number of bytes to queue
+     * @return Status::Ok on success, Status::NoMemory if the ring lacks space
+     */
+    Status transmitDMA(const u8* data, size_t length);
+
+    /**
+     * @brief Get free space in the TX ring
+     * @return Number of bytes that can be queued without blocking
+     */
+    size_t getTxFree() const;
+
     /**
      * @brief Check if transmit is complete
      * @return true if ready for next transmission
@@ -178,6 +288,8 @@ public:
 
     /**
      * @brief Flush transmit buffer
+     * 
+     * Waits for queued DMA data to drain before returning.
      */
     void flushTx();
 
@@ -201,13 +313,46 @@ private:
     void*       m_rxContext;
     void*       m_txContext;
     
-    u8          m_txBuffer[UART_BUFFER_SIZE];
-    volatile u16 m_txHead;
-    volatile u16 m_txTail;
+    RingBuffer<u8, UART_BUFFER_SIZE> m_txRing;  ///< Consumed on DMA completion
+    volatile u16 m_txDmaLength;     ///< Bytes in the active DMA span (0 = idle)
+    Dma*        m_txDma;            ///< TX DMA stream
+    
+    FrameCallback m_frameCallback;
+    void*       m_frameContext;
+    u8          m_rxDmaBuffer[UART_RX_DMA_BUFFER_SIZE];
+    u16         m_rxReadPos;        ///< Ring offset of the first undelivered byte
+    u32         m_rxCrc;            ///< Running CRC of delivered bytes (Config::rxCrc)
+    Dma*        m_rxDma;            ///< RX DMA stream
+    ClockListener m_clockListener;  ///< Registered by init()
+    Semaphore   m_rxSignal;         ///< Given on RX data, taken by blocking receive()
     
     void enableClock();
     void configurePins();
     void configureNvic();
+    Status configureTxDma();
+    void startTxDma();
+    Status configureRxDma();
+
+    /**
+     * @brief TX DMA event callback
+     * 
+     * Releases the span that was just sent and starts the next one if
+     * more bytes are queued. Runs without masking interrupts: the ring
+     * is SPSC between transmitDMA() and this handler.
+     */
+    static void onTxDma(u32 events, void* context);
+
+    /**
+     * @brief RX DMA event callback (half/full transfer)
+     */
+    static void onRxDma(u32 events, void* context);
+
+    /**
+     * @brief Clock profile change callback
+     * 
+     * Reapplies Config::baudRate for the new APB clock.
+     */
+    static void onClockChange(void* context);
 };
 
 } // namespace hal
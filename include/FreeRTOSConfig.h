@@ -0,0 +1,98 @@
+/**
+ * @file FreeRTOSConfig.h
+ * @brief FreeRTOS kernel configuration (USE_RTOS=1)
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ *
+ * Included by the FreeRTOS C sources as well; keep it plain C. Clock and
+ * tick values come from config.hpp, see rtos.hpp for how the kernel is
+ * tied into SysTick and the idle path.
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include "config.hpp"
+
+/*============================================================================
+ * Kernel
+ *===========================================================================*/
+#define configUSE_PREEMPTION                    1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+#define configCPU_CLOCK_HZ                      SYSTEM_CLOCK_HZ
+#define configTICK_RATE_HZ                      TICK_RATE_HZ
+#define configMAX_PRIORITIES                    RTOS_MAX_PRIORITIES
+#define configMINIMAL_STACK_SIZE                RTOS_IDLE_STACK
+#define configMAX_TASK_NAME_LEN                 12
+#define configUSE_16_BIT_TICKS                  0
+#define configSTACK_DEPTH_TYPE                  uint32_t
+#define configIDLE_SHOULD_YIELD                 1
+#define configUSE_MUTEXES                       1
+#define configUSE_RECURSIVE_MUTEXES             0
+#define configUSE_COUNTING_SEMAPHORES           1
+#define configQUEUE_REGISTRY_SIZE               0
+#define configUSE_TIMERS                        0       // SoftTimer covers timers
+#define configUSE_CO_ROUTINES                   0
+
+/*============================================================================
+ * Memory
+ *===========================================================================*/
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        1
+#define configTOTAL_HEAP_SIZE                   RTOS_HEAP_SIZE
+
+/*============================================================================
+ * Hooks and Checks
+ *===========================================================================*/
+#define configUSE_IDLE_HOOK                     1       // Sleeps and feeds Profiler idle time
+#define configUSE_TICK_HOOK                     0
+#define configUSE_MALLOC_FAILED_HOOK            0
+#define configCHECK_FOR_STACK_OVERFLOW          (DEBUG_ENABLED ? 2 : 0)
+
+#if DEBUG_ENABLED
+#define configASSERT(x)                         if (!(x)) { taskDISABLE_INTERRUPTS(); for (;;) {} }
+#endif
+
+/*============================================================================
+ * Tick and Tickless Idle
+ *===========================================================================*/
+// SysTick is configured by System::init() (and reloaded on clock profile
+// changes) and ticks the kernel from SysTick_Handler. src/rtos.cpp
+// provides an empty vPortSetupTimerInterrupt() so xPortStartScheduler()
+// leaves it alone
+#define configOVERRIDE_DEFAULT_TICK_CONFIGURATION 1
+
+// 2: vPortSuppressTicksAndSleep() is provided by src/rtos.cpp
+#define configUSE_TICKLESS_IDLE                 (LOW_POWER_MODE ? 2 : 0)
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP   2
+
+/*============================================================================
+ * Interrupt Priorities
+ *===========================================================================*/
+// Raw NVIC values on the 4 implemented bits. Kernel calls are allowed up
+// to irqPriorityValue(IrqPriority::High); IrqPriority::Highest handlers
+// are never masked by the kernel
+#define configPRIO_BITS                         4
+#define configKERNEL_INTERRUPT_PRIORITY         0xF0
+#define configMAX_SYSCALL_INTERRUPT_PRIORITY    0x30
+
+/*============================================================================
+ * Optional Functions
+ *===========================================================================*/
+#define INCLUDE_vTaskDelay                      1
+#define INCLUDE_vTaskDelayUntil                 1
+#define INCLUDE_vTaskSuspend                    1       // portMAX_DELAY blocks forever
+#define INCLUDE_vTaskDelete                     0
+#define INCLUDE_xTaskGetSchedulerState          1
+#define INCLUDE_xTaskGetCurrentTaskHandle       1
+
+/*============================================================================
+ * Handler Mapping
+ *===========================================================================*/
+// The port's handlers replace the weak startup.cpp defaults; the SysTick
+// handler stays the framework's own (see Rtos::tick())
+#define vPortSVCHandler                         SVC_Handler
+#define xPortPendSVHandler                      PendSV_Handler
+
+#endif // FREERTOS_CONFIG_H
@@ -17,13 +17,22 @@
 #define TARGET_LPC1768          0
 #define TARGET_NRF52            0
 
+#ifndef EMBEDDED_HOST_BUILD
+#define EMBEDDED_HOST_BUILD     0               // 1: x86/Linux on sim/ (set by the build)
+#endif
+
 /*============================================================================
  * System Clock Configuration
  *===========================================================================*/
+// Boot (ClockProfile::Performance) values; System::get*Clock() at runtime
 #define SYSTEM_CLOCK_HZ         168000000UL     // 168 MHz system clock
 #define AHB_CLOCK_HZ            SYSTEM_CLOCK_HZ
 #define APB1_CLOCK_HZ           (SYSTEM_CLOCK_HZ / 4)
 #define APB2_CLOCK_HZ           (SYSTEM_CLOCK_HZ / 2)
+#define HSE_CLOCK_HZ            8000000UL       // External crystal
+#define HSI_CLOCK_HZ            16000000UL      // Internal RC oscillator
+#define CLOCK_HSE_TIMEOUT       0x20000         // HSE ready polls before falling back to HSI
+#define CLOCK_PLL_TIMEOUT       0x20000         // PLL lock polls in setClockProfile()
 
 /*============================================================================
  * SysTick Configuration
@@ -34,26 +43,99 @@
 /*============================================================================
  * Feature Flags
  *===========================================================================*/
-#define USE_RTOS                0               // 0: Bare-metal, 1: FreeRTOS
+#ifndef USE_RTOS
+#define USE_RTOS                0               // 0: Bare-metal, 1: FreeRTOS (set by the build)
+#endif
 #define DEBUG_ENABLED           1               // Enable debug output
 #define USE_WATCHDOG            1               // Enable watchdog timer
-#define LOW_POWER_MODE          0               // Enable low power features
+#define LOW_POWER_MODE          0               // Enable low power features (tickless idle)
+
+/*============================================================================
+ * RTOS Configuration (USE_RTOS, see FreeRTOSConfig.h)
+ *===========================================================================*/
+#define RTOS_MAX_PRIORITIES     8
+#define RTOS_HEAP_SIZE          (16 * 1024)     // heap_4 bytes for dynamically created objects
+#define RTOS_IDLE_STACK         128             // Idle task stack (words)
+#define RTOS_SCHEDULER_STACK    512             // Scheduler::run() task stack (words)
+#define RTOS_SCHEDULER_PRIORITY 1               // Scheduler::run() task priority
+
+/*============================================================================
+ * Boot Configuration
+ *===========================================================================*/
+#define BOOT_LAZY_INIT          0               // 1: bring up debug UART/log after the first tasks run
+
+/*============================================================================
+ * Scheduler Configuration
+ *===========================================================================*/
+#define SCHEDULER_WHEEL_SLOTS   64              // Timer wheel size (power of two)
+
+/*============================================================================
+ * Memory Pool Configuration
+ *===========================================================================*/
+#define MEMORY_POOL_SMALL_SIZE  32              // Block sizes (multiples of 8)
+#define MEMORY_POOL_SMALL_COUNT 64
+#define MEMORY_POOL_MEDIUM_SIZE 128
+#define MEMORY_POOL_MEDIUM_COUNT 16
+#define MEMORY_POOL_LARGE_SIZE  512
+#define MEMORY_POOL_LARGE_COUNT 4
+#define MEMORY_ARENA_SIZE       2048            // Bump arena bytes
 
 /*============================================================================
  * Peripheral Configuration
  *===========================================================================*/
-#define UART_BUFFER_SIZE        256
+#define UART_BUFFER_SIZE        256             // Power of two (RingBuffer)
+#define UART_RX_DMA_BUFFER_SIZE 512             // Circular DMA receive ring
 #define SPI_BUFFER_SIZE         128
+#define SPI_BUS_QUEUE_DEPTH     8               // SpiBus transactions (power of two)
 #define I2C_TIMEOUT_MS          100
+#define I2C_DMA_THRESHOLD       4               // Async payloads >= this use DMA
+#define I2C_SCHEDULER_BURST_SIZE 32             // Max bytes per merged burst read
+#define I2C_SCHEDULER_MAX_MERGE 8               // Max jobs merged into one burst
+#define CRC_DMA_THRESHOLD       256             // Crc::crc32WordsDma() words fed by DMA from here
+
+/*============================================================================
+ * LED Bank Configuration
+ *===========================================================================*/
+#define LED_BANK_MAX_LEDS       48              // LEDs per LedBank
+#define LED_BANK_MAX_PORTS      4               // Distinct GPIO ports per LedBank
+#define LED_BANK_STEP_MS        50              // Pattern table resolution
 
 /*============================================================================
  * Debug Configuration
  *===========================================================================*/
+#define DEBUG_BACKEND_UART      0               // Log frames on DEBUG_UART_PORT
+#define DEBUG_BACKEND_ITM       1               // Log frames and profiler events on SWO
+
+#ifndef DEBUG_BACKEND
+#define DEBUG_BACKEND           DEBUG_BACKEND_UART
+#endif
+
 #if DEBUG_ENABLED
     #define DEBUG_UART_BAUDRATE 115200
     #define DEBUG_UART_PORT     USART2
 #endif
 
+#define ITM_SWO_BAUDRATE        2000000         // SWO bit rate (probe must match)
+#define ITM_PORT_LOG            0               // Stimulus port: binary log frames
+#define ITM_PORT_PROFILE        1               // Stimulus port: profiler events
+#define ITM_PORT_DATA           2               // First stimulus port for data samples
+#define ITM_DATA_CHANNELS       4               // Data sample channels (ports)
+
+/*============================================================================
+ * Logging Configuration
+ *===========================================================================*/
+#define LOG_ENABLED             1               // Binary logging (log.hpp)
+#define LOG_LEVEL               1               // 0: Debug, 1: Info, 2: Warning, 3: Error
+#define LOG_BUFFER_RECORDS      64              // Queued records (power of two)
+#define LOG_MAX_ARGS            4               // Arguments per record
+
+/*============================================================================
+ * Profiling Configuration
+ *===========================================================================*/
+#define PROFILER_ENABLED        DEBUG_ENABLED   // ISR/task cycle accounting (profiler.hpp)
+#define PROFILER_TASK_SLOTS     8               // Named scheduler task entries
+#define PROFILER_MAX_NESTING    8               // Tracked handler nesting depth
+
 /*============================================================================
  * Version Information
  *===========================================================================*/
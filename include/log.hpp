@@ -0,0 +1,148 @@
+/**
+ * @file log.hpp
+ * @brief Deferred binary logging
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include "types.hpp"
+#include "config.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+namespace embedded {
+
+namespace hal {
+class UART;
+}
+
+/**
+ * @class Log
+ * @brief Binary logger deferring all formatting to the host
+ * 
+ * A log call stores only the address of its format string, a cycle
+ * timestamp and up to LOG_MAX_ARGS raw 32-bit arguments into a lock-free
+ * record queue; it never formats or touches the UART. Format strings
+ * live in the non-loaded .log_strings section, so they cost no flash and
+ * their address is their ID. process() streams the queued records over
+ * the debug UART (or the ITM log port, see DEBUG_BACKEND) and
+ * tools/log_decode.py rebuilds the text from the ELF.
+ * 
+ * Log calls are safe from any context, including nested interrupts.
+ * When the queue is full new records are dropped and counted.
+ * 
+ * Timestamps are the 32-bit DWT cycle count. After a silence of half a
+ * wrap or more (12.8 s at 168 MHz) process() sends a time sync frame
+ * first, so decoded times stay absolute across long gaps. A record must
+ * be sent within one wrap (25.6 s) of being logged.
+ * 
+ * Only numeric arguments are supported (integers, enums, pointers and
+ * floats, which are sent as single precision).
+ */
+class Log {
+public:
+    /**
+     * @brief Log severity levels
+     */
+    enum class Level : u8 {
+        Debug   = 0,
+        Info    = 1,
+        Warning = 2,
+        Error   = 3
+    };
+
+    /**
+     * @brief Attach the output UART
+     * 
+     * Records logged before init() are kept and sent on the first
+     * process() call.
+     * 
+     * @param uart Debug UART (DMA transmit recommended); unused with
+     *        DEBUG_BACKEND_ITM, may be nullptr
+     */
+    static void init(hal::UART* uart);
+
+    /**
+     * @brief Queue a record (use the LOG_* macros instead)
+     * @param level Severity
+     * @param id Format string in .log_strings
+     * @param format Format string literal (compile-time checks only)
+     * @param args Numeric arguments
+     */
+    template <size_t N, typename... Args>
+    static void write(Level level, const char* id, const char (&format)[N], Args... args) {
+        static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+        UNUSED(format);
+        const u32 words[] = { toWord(args)..., 0 };
+        record(level, id, words, sizeof...(Args));
+    }
+
+    /**
+     * @brief Stream queued records to the debug output
+     * 
+     * Sends as many records as fit in the UART TX ring (or the ITM
+     * FIFO) and returns. Call from a low-priority periodic task.
+     */
+    static void process();
+
+    /**
+     * @brief Get number of records dropped because the queue was full
+     * @return Dropped record count since reset
+     */
+    static u32 getDropped();
+
+private:
+    static void record(Level level, const char* id, const u32* args, u8 argc);
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, u32>::type
+    toWord(T value) {
+        return static_cast<u32>(value);
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value, u32>::type
+    toWord(T value) {
+        f32 single = static_cast<f32>(value);
+        u32 bits;
+        std::memcpy(&bits, &single, sizeof(bits));
+        return bits;
+    }
+
+    template <typename T>
+    static u32 toWord(T* value) {
+        return static_cast<u32>(reinterpret_cast<uintptr_t>(value));
+    }
+};
+
+} // namespace embedded
+
+/*============================================================================
+ * Logging Macros
+ *===========================================================================*/
+#define LOG_FORMAT_(format, ...)    format
+
+#if LOG_ENABLED
+    #define LOG_WRITE(level, ...)                                               \
+        do {                                                                    \
+            if (static_cast<int>(level) >= LOG_LEVEL) {                         \
+                __attribute__((section(".log_strings")))                        \
+                static const char logFormat_[] = LOG_FORMAT_(__VA_ARGS__, 0);   \
+                ::embedded::Log::write(level, logFormat_, __VA_ARGS__);         \
+            }                                                                   \
+        } while (0)
+#else
+    #define LOG_WRITE(level, ...)   do { } while (0)
+#endif
+
+#define LOG_DEBUG(...)  LOG_WRITE(::embedded::Log::Level::Debug, __VA_ARGS__)
+#define LOG_INFO(...)   LOG_WRITE(::embedded::Log::Level::Info, __VA_ARGS__)
+#define LOG_WARN(...)   LOG_WRITE(::embedded::Log::Level::Warning, __VA_ARGS__)
+#define LOG_ERROR(...)  LOG_WRITE(::embedded::Log::Level::Error, __VA_ARGS__)
+
+#endif // LOG_HPP
@@ -0,0 +1,234 @@
+/**
+ * @file memory.hpp
+ * @brief Deterministic fixed-block pool and bump arena allocators
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include "types.hpp"
+#include "config.hpp"
+
+namespace embedded {
+
+/// Place allocator storage in the non-initialized .pool section (DMA capable SRAM)
+#if EMBEDDED_HOST_BUILD
+#define POOL_STORAGE            __attribute__((aligned(8)))
+#else
+#define POOL_STORAGE            __attribute__((section(".pool"), aligned(8)))
+#endif
+
+/**
+ * @brief Allocator usage statistics
+ */
+struct MemoryStats {
+    size_t  used;           ///< Blocks (pool) or bytes (arena) in use
+    size_t  highWater;      ///< Peak of used since reset
+    u32     failures;       ///< Allocations that could not be satisfied
+};
+
+/**
+ * @class Pool
+ * @brief Fixed-block allocator with O(1) allocate and free
+ *
+ * Free blocks form an intrusive list. Blocks that were never handed out
+ * are carved from the storage on demand, so a pool needs no runtime
+ * initialization and is usable before static constructors run. Both
+ * operations are ISR-safe (short critical section).
+ */
+class Pool {
+public:
+    /**
+     * @brief Construct pool over caller-provided storage
+     * @param storage Block storage (blockSize * blockCount bytes, 8-byte aligned)
+     * @param blockSize Block size in bytes (multiple of 8)
+     * @param blockCount Number of blocks
+     */
+    constexpr Pool(void* storage, size_t blockSize, size_t blockCount)
+        : m_storage(static_cast<u8*>(storage))
+        , m_blockSize(blockSize)
+        , m_blockCount(blockCount)
+        , m_carved(0)
+        , m_freeList(nullptr)
+        , m_used(0)
+        , m_highWater(0)
+        , m_failures(0) {}
+
+    // Non-copyable
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    /**
+     * @brief Allocate one block
+     * @return Block pointer, or nullptr if the pool is exhausted
+     */
+    void* allocate();
+
+    /**
+     * @brief Return a block to the pool
+     * @param block Block obtained from allocate()
+     * @return Status::Ok, or Status::InvalidArg if the block was not
+     *         handed out by this pool (double frees are detected with
+     *         DEBUG_ENABLED)
+     */
+    Status free(void* block);
+
+    /**
+     * @brief Check whether a pointer belongs to this pool
+     * @param ptr Pointer to test
+     * @return true if ptr lies in the pool storage
+     */
+    bool owns(const void* ptr) const {
+        const u8* p = static_cast<const u8*>(ptr);
+        return p >= m_storage && p < m_storage + m_blockSize * m_blockCount;
+    }
+
+    /**
+     * @brief Get block size
+     * @return Block size in bytes
+     */
+    size_t getBlockSize() const { return m_blockSize; }
+
+    /**
+     * @brief Get block count
+     * @return Total number of blocks
+     */
+    size_t getBlockCount() const { return m_blockCount; }
+
+    /**
+     * @brief Get usage statistics (in blocks)
+     * @return Snapshot of the statistics
+     */
+    MemoryStats getStats() const;
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    u8*         m_storage;
+    size_t      m_blockSize;
+    size_t      m_blockCount;
+    size_t      m_carved;           ///< Blocks ever handed out from storage
+    FreeBlock*  m_freeList;
+    size_t      m_used;
+    size_t      m_highWater;
+    u32         m_failures;
+};
+
+/**
+ * @class Arena
+ * @brief Bump allocator released all at once
+ *
+ * For buffers that live for a whole phase (e.g. allocated at startup or
+ * per frame). allocate() is O(1) and ISR-safe; memory is only reclaimed
+ * by reset().
+ */
+class Arena {
+public:
+    /**
+     * @brief Construct arena over caller-provided storage
+     * @param storage Arena storage (8-byte aligned)
+     * @param size Storage size in bytes
+     */
+    constexpr Arena(void* storage, size_t size)
+        : m_storage(static_cast<u8*>(storage))
+        , m_size(size)
+        , m_offset(0)
+        , m_highWater(0)
+        , m_failures(0) {}
+
+    // Non-copyable
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief Allocate from the arena
+     * @param size Size in bytes
+     * @param alignment Alignment in bytes (power of two)
+     * @return Pointer, or nullptr if the arena is exhausted
+     */
+    void* allocate(size_t size, size_t alignment = 8);
+
+    /**
+     * @brief Release every allocation
+     * @note Only call when no arena allocation is still referenced
+     */
+    void reset();
+
+    /**
+     * @brief Check whether a pointer belongs to this arena
+     * @param ptr Pointer to test
+     * @return true if ptr lies in the arena storage
+     */
+    bool owns(const void* ptr) const {
+        const u8* p = static_cast<const u8*>(ptr);
+        return p >= m_storage && p < m_storage + m_size;
+    }
+
+    /**
+     * @brief Get usage statistics (in bytes)
+     * @return Snapshot of the statistics
+     */
+    MemoryStats getStats() const;
+
+private:
+    u8*     m_storage;
+    size_t  m_size;
+    size_t  m_offset;
+    size_t  m_highWater;
+    u32     m_failures;
+};
+
+/**
+ * @class Memory
+ * @brief System allocator backing global operator new/delete
+ *
+ * Requests are served from the smallest pool whose block fits. The
+ * newlib heap is disabled (_sbrk always fails), so every dynamic
+ * allocation has bounded latency.
+ */
+class Memory {
+public:
+    /**
+     * @brief System pool identifiers
+     */
+    enum class PoolId : u8 {
+        Small   = 0,
+        Medium  = 1,
+        Large   = 2
+    };
+
+    /**
+     * @brief Allocate from the best fitting system pool
+     * @param size Size in bytes
+     * @return Pointer, or nullptr if no pool can satisfy the request
+     */
+    static void* allocate(size_t size);
+
+    /**
+     * @brief Free a pointer from allocate()
+     * @param ptr Pointer (nullptr is ignored)
+     */
+    static void free(void* ptr);
+
+    /**
+     * @brief Get a system pool
+     * @param id Pool identifier
+     * @return Pool reference
+     */
+    static Pool& getPool(PoolId id);
+
+    /**
+     * @brief Get the system arena
+     * @return Arena reference
+     */
+    static Arena& getArena();
+};
+
+} // namespace embedded
+
+#endif // MEMORY_HPP
@@ -0,0 +1,177 @@
+/**
+ * @file profiler.hpp
+ * @brief Runtime cycle accounting for interrupts and scheduler tasks
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include "types.hpp"
+#include "config.hpp"
+#include "scheduler.hpp"
+
+namespace embedded {
+
+namespace hal {
+class UART;
+}
+
+/**
+ * @class Profiler
+ * @brief Per-handler cycle counts, latency and idle time
+ *
+ * Handlers are bracketed with PROFILE_ISR() (interrupts) and the
+ * scheduler brackets every task it dispatches. Each slot accumulates
+ * its call count, exclusive DWT cycles (time spent in higher-priority
+ * handlers that preempted it is charged to those) and its longest
+ * single run. The table lives in CCM and is only written with
+ * interrupts masked for a few instructions per hook.
+ *
+ * Idle time is the time spent in the scheduler's idle sleep (with
+ * USE_RTOS, the idle task's sleep and tickless idle). It is
+ * derived from busy cycles against SysTick wall time, so it stays
+ * right when the core clock (and CYCCNT) is gated during WFI.
+ *
+ * With PROFILER_ENABLED set to 0 all hooks compile to nothing and the
+ * table stays empty.
+ */
+class Profiler {
+public:
+    /**
+     * @brief Fixed slots
+     *
+     * Scheduler tasks without a slot of their own are charged to Tasks;
+     * attach() adds named task slots after Count.
+     */
+    enum class Slot : u8 {
+        Tasks   = 0,
+        SysTick,
+        Exti,
+        Uart,
+        Spi,
+        I2c,
+        Dma,
+        Count
+    };
+
+    /**
+     * @brief Statistics of one slot
+     */
+    struct Entry {
+        const char* name;
+        u32     calls;
+        u64     cycles;                 ///< Exclusive cycles, all calls
+        u32     maxCycles;              ///< Longest single call
+        u32     maxLatency;             ///< Longest event-to-entry delay, cycles
+    };
+
+    /**
+     * @brief Number of table entries (fixed and named task slots)
+     */
+    static constexpr size_t SLOTS = static_cast<size_t>(Slot::Count) + PROFILER_TASK_SLOTS;
+
+    /**
+     * @brief Give a scheduler task a slot of its own
+     *
+     * Takes effect from the next run of the task.
+     *
+     * @param task Task to account separately
+     * @param name Name reported with the entry (static string)
+     * @return Status::Ok, Status::InvalidArg, or Status::NoMemory when
+     *         all PROFILER_TASK_SLOTS are taken
+     */
+    static Status attach(Scheduler::Task* task, const char* name);
+
+    /**
+     * @brief Clear all counters and restart the idle window
+     */
+    static void reset();
+
+    /**
+     * @brief Copy one entry
+     * @param index 0 .. SLOTS - 1
+     * @param entry Receives a consistent snapshot
+     * @return false if the index is out of range or the slot is unused
+     */
+    static bool read(size_t index, Entry& entry);
+
+    /**
+     * @brief Get the idle share since the last reset()
+     *
+     * The window also restarts on every System::setClockProfile(), as
+     * cycle counts from different clocks do not add up.
+     *
+     * @return Percentage of wall time spent in the idle sleep
+     */
+    static u8 getIdlePercent();
+
+    /**
+     * @brief Dump the table as text lines
+     *
+     * One "PROF,<name>,<calls>,<cycles>,<max>,<maxLatency>" line per
+     * used slot, then "PROF_IDLE,<percent>".
+     *
+     * @param uart Output UART
+     */
+    static void print(hal::UART* uart);
+
+    /**
+     * @brief Scope guard behind PROFILE_SCOPE() and PROFILE_ISR()
+     */
+    class Scope {
+    public:
+        explicit Scope(Slot slot, u32 latency = 0) : m_slot(static_cast<u8>(slot)) {
+            enter(m_slot, latency);
+        }
+
+        explicit Scope(u8 slot, u32 latency = 0) : m_slot(slot) {
+            enter(m_slot, latency);
+        }
+
+        ~Scope() {
+            exit(m_slot);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        u8 m_slot;
+    };
+
+    /**
+     * @brief Hooks around the scheduler's (or RTOS idle task's) sleep
+     */
+    static void idleBegin();
+    static void idleEnd();
+
+private:
+    static void enter(u8 slot, u32 latency);
+    static void exit(u8 slot);
+};
+
+} // namespace embedded
+
+/*============================================================================
+ * Profiling Macros
+ *===========================================================================*/
+#if PROFILER_ENABLED
+    #define PROFILE_SCOPE(slot)                                                 \
+        ::embedded::Profiler::Scope profileScope_(slot)
+    #define PROFILE_SCOPE_LATENCY(slot, latency)                                \
+        ::embedded::Profiler::Scope profileScope_(slot, latency)
+    #define PROFILE_IDLE_BEGIN()    ::embedded::Profiler::idleBegin()
+    #define PROFILE_IDLE_END()      ::embedded::Profiler::idleEnd()
+#else
+    #define PROFILE_SCOPE(slot)                     do { } while (0)
+    #define PROFILE_SCOPE_LATENCY(slot, latency)    do { } while (0)
+    #define PROFILE_IDLE_BEGIN()                    do { } while (0)
+    #define PROFILE_IDLE_END()                      do { } while (0)
+#endif
+
+#define PROFILE_ISR(name)   PROFILE_SCOPE(::embedded::Profiler::Slot::name)
+
+#endif // PROFILER_HPP
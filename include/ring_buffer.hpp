@@ -0,0 +1,232 @@
+/**
+ * @file ring_buffer.hpp
+ * @brief Lock-free single-producer/single-consumer ring buffer
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include "types.hpp"
+
+namespace embedded {
+
+/**
+ * @class RingBuffer
+ * @brief Fixed-capacity SPSC queue for ISR-to-thread data paths
+ * 
+ * One context may produce (push/pushN/writeSpan/commit) and one other
+ * context may consume (pop/popN/peek/readSpan/consume) concurrently
+ * without disabling interrupts. Head and tail are free-running counters
+ * masked with N - 1, so all N slots are usable. Each index is only ever
+ * written by its owning side and published after a DMB.
+ * 
+ * readSpan()/writeSpan() expose the largest contiguous region so a DMA
+ * stream can work on the storage directly; the span stays owned by the
+ * caller until consume()/commit().
+ * 
+ * @tparam T Element type (trivially copyable)
+ * @tparam N Capacity, a power of two
+ */
+template <typename T, size_t N>
+class RingBuffer {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "RingBuffer capacity must be a power of two");
+
+public:
+    RingBuffer() : m_head(0), m_tail(0) {}
+
+    // Non-copyable
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    /**
+     * @brief Get capacity
+     * @return Maximum number of elements
+     */
+    static constexpr size_t capacity() { return N; }
+
+    /**
+     * @brief Get number of queued elements
+     * @return Elements available to the consumer
+     */
+    size_t size() const { return m_head - m_tail; }
+
+    /**
+     * @brief Get free space
+     * @return Elements the producer can still push
+     */
+    size_t available() const { return N - size(); }
+
+    /**
+     * @brief Check if empty
+     * @return true if nothing is queued
+     */
+    bool empty() const { return m_head == m_tail; }
+
+    /**
+     * @brief Check if full
+     * @return true if no space is left
+     */
+    bool full() const { return size() == N; }
+
+    /**
+     * @brief Push one element (producer)
+     * @param item Element to push
+     * @return true on success, false if full
+     */
+    bool push(const T& item) {
+        u32 head = m_head;
+        if (head - m_tail == N) {
+            return false;
+        }
+        DMB();
+        m_buffer[head & MASK] = item;
+        DMB();
+        m_head = head + 1;
+        return true;
+    }
+
+    /**
+     * @brief Push up to count elements (producer)
+     * @param items Source elements
+     * @param count Number of elements offered
+     * @return Number of elements pushed
+     */
+    size_t pushN(const T* items, size_t count) {
+        u32 head = m_head;
+        size_t space = N - (head - m_tail);
+        if (count > space) {
+            count = space;
+        }
+        DMB();
+        for (size_t i = 0; i < count; i++) {
+            m_buffer[(head + i) & MASK] = items[i];
+        }
+        DMB();
+        m_head = head + count;
+        return count;
+    }
+
+    /**
+     * @brief Pop one element (consumer)
+     * @param item Destination
+     * @return true on success, false if empty
+     */
+    bool pop(T& item) {
+        u32 tail = m_tail;
+        if (m_head == tail) {
+            return false;
+        }
+        DMB();
+        item = m_buffer[tail & MASK];
+        DMB();
+        m_tail = tail + 1;
+        return true;
+    }
+
+    /**
+     * @brief Pop up to count elements (consumer)
+     * @param items Destination
+     * @param count Maximum number of elements
+     * @return Number of elements popped
+     */
+    size_t popN(T* items, size_t count) {
+        u32 tail = m_tail;
+        size_t queued = m_head - tail;
+        if (count > queued) {
+            count = queued;
+        }
+        DMB();
+        for (size_t i = 0; i < count; i++) {
+            items[i] = m_buffer[(tail + i) & MASK];
+        }
+        DMB();
+        m_tail = tail + count;
+        return count;
+    }
+
+    /**
+     * @brief Read the oldest element without removing it (consumer)
+     * @param item Destination
+     * @return true on success, false if empty
+     */
+    bool peek(T& item) const {
+        u32 tail = m_tail;
+        if (m_head == tail) {
+            return false;
+        }
+        DMB();
+        item = m_buffer[tail & MASK];
+        return true;
+    }
+
+    /**
+     * @brief Get contiguous readable region (consumer)
+     * @param data Set to the oldest queued element
+     * @return Number of contiguous elements at @p data
+     */
+    size_t readSpan(const T*& data) const {
+        u32 tail = m_tail;
+        size_t queued = m_head - tail;
+        size_t offset = tail & MASK;
+        size_t toEnd = N - offset;
+        DMB();
+        data = &m_buffer[offset];
+        return (queued < toEnd) ? queued : toEnd;
+    }
+
+    /**
+     * @brief Release elements obtained through readSpan() (consumer)
+     * @param count Number of elements consumed
+     */
+    void consume(size_t count) {
+        DMB();
+        m_tail = m_tail + count;
+    }
+
+    /**
+     * @brief Get contiguous writable region (producer)
+     * @param data Set to the first free slot
+     * @return Number of contiguous free slots at @p data
+     */
+    size_t writeSpan(T*& data) {
+        u32 head = m_head;
+        size_t space = N - (head - m_tail);
+        size_t offset = head & MASK;
+        size_t toEnd = N - offset;
+        DMB();
+        data = &m_buffer[offset];
+        return (space < toEnd) ? space : toEnd;
+    }
+
+    /**
+     * @brief Publish elements written through writeSpan() (producer)
+     * @param count Number of elements written
+     */
+    void commit(size_t count) {
+        DMB();
+        m_head = m_head + count;
+    }
+
+    /**
+     * @brief Drop all queued elements
+     * 
+     * Only valid while neither side is active.
+     */
+    void clear() {
+        m_tail = m_head;
+    }
+
+private:
+    static constexpr u32 MASK = N - 1;
+
+    T               m_buffer[N];
+    volatile u32    m_head;     ///< Write counter (producer-owned)
+    volatile u32    m_tail;     ///< Read counter (consumer-owned)
+};
+
+} // namespace embedded
+
+#endif // RING_BUFFER_HPP
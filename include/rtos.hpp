@@ -0,0 +1,138 @@
+/**
+ * @file rtos.hpp
+ * @brief RTOS integration (USE_RTOS) and blocking primitives
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef RTOS_HPP
+#define RTOS_HPP
+
+#include "types.hpp"
+#include "config.hpp"
+#include "system.hpp"
+
+#if USE_RTOS
+#if EMBEDDED_HOST_BUILD
+#error "USE_RTOS needs the FreeRTOS Cortex-M4F port; the host build is bare-metal only"
+#endif
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#endif
+
+namespace embedded {
+
+/**
+ * @class Rtos
+ * @brief FreeRTOS kernel glue
+ *
+ * With USE_RTOS=1 the FreeRTOS port owns SVC and PendSV (mapped in
+ * FreeRTOSConfig.h) and is ticked from the framework's SysTick_Handler,
+ * so System ticks, SoftTimer and the kernel tick stay in lockstep. The
+ * port moves SysTick to the kernel priority when the kernel starts, so
+ * SoftTimer callbacks then run below every other interrupt. Tickless
+ * idle (LOW_POWER_MODE) goes through System::idleUntil(), bounded by the
+ * next SoftTimer expiry.
+ *
+ * IrqPriority::Highest handlers run above configMAX_SYSCALL_INTERRUPT_PRIORITY
+ * and must not call kernel functions, Semaphore::give() included.
+ */
+class Rtos {
+public:
+#if USE_RTOS
+    /**
+     * @brief Check whether the kernel has started
+     * @return true once start() handed over to the kernel
+     */
+    static bool isRunning() {
+        return xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED;
+    }
+
+    /**
+     * @brief Check whether the caller is an exception handler
+     * @return true in interrupt context (IPSR != 0)
+     */
+    static bool inInterrupt() {
+        u32 ipsr;
+        __asm volatile ("mrs %0, ipsr" : "=r" (ipsr));
+        return ipsr != 0;
+    }
+
+    /**
+     * @brief Run Scheduler::run() as an RTOS task and start the kernel
+     *
+     * Create the application's own tasks before calling this. The
+     * scheduler task runs at RTOS_SCHEDULER_PRIORITY and blocks while
+     * no scheduler task is due.
+     */
+    [[noreturn]] static void start();
+
+private:
+    friend void ::SysTick_Handler(void);
+
+    /**
+     * @brief Advance the kernel tick (from SysTick_Handler)
+     */
+    static void tick();
+#else
+    static constexpr bool isRunning() { return false; }
+#endif
+};
+
+/**
+ * @class Semaphore
+ * @brief Binary semaphore for blocking until an interrupt signals
+ *
+ * Drivers use it to turn timeout loops into sleeps: the waiting side
+ * calls take(), the interrupt that completes the operation calls
+ * give(). A give() without a waiter is remembered, so checking a
+ * condition and then taking never misses a wake-up.
+ *
+ * With USE_RTOS=1 take() blocks the calling task and the CPU runs
+ * other tasks (or sleeps tickless) meanwhile. Bare-metal, and before
+ * the kernel starts, take() sleeps the core between interrupts.
+ * give() is safe from any context; take() polls without waiting when
+ * called from an interrupt.
+ */
+class Semaphore {
+public:
+    static constexpr u32 WAIT_FOREVER = 0xFFFFFFFF;
+
+    /**
+     * @brief Constructor (not given)
+     */
+    Semaphore();
+
+    /**
+     * @brief Destructor
+     */
+    ~Semaphore();
+
+    /**
+     * @brief Wait until the semaphore is given
+     * @param timeoutMs Timeout in milliseconds (0: poll, WAIT_FOREVER)
+     * @return true if taken, false on timeout
+     */
+    bool take(u32 timeoutMs);
+
+    /**
+     * @brief Give the semaphore, waking the waiter
+     */
+    void give();
+
+private:
+#if USE_RTOS
+    StaticSemaphore_t   m_storage;
+    SemaphoreHandle_t volatile m_handle;    ///< Created by the first take() in a task
+#endif
+    volatile bool       m_given;            ///< Given without a kernel object
+
+    Semaphore(const Semaphore&) = delete;
+    Semaphore& operator=(const Semaphore&) = delete;
+};
+
+} // namespace embedded
+
+#endif // RTOS_HPP
@@ -0,0 +1,139 @@
+/**
+ * @file scheduler.hpp
+ * @brief Cooperative event-driven task scheduler
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include "types.hpp"
+#include "config.hpp"
+
+#if USE_RTOS
+#include "rtos.hpp"
+#endif
+
+namespace embedded {
+
+/**
+ * @class Scheduler
+ * @brief Run-to-completion scheduler for periodic and event tasks
+ * 
+ * Tasks are statically allocated by the caller. Timed tasks live in a
+ * timer wheel of SCHEDULER_WHEEL_SLOTS one-tick slots; when they expire,
+ * or when an interrupt posts them, they move to a ready queue that is
+ * dispatched in deadline order. When nothing is ready the core sleeps
+ * until the next timer deadline (task or SoftTimer) via
+ * System::idleUntil(). With USE_RTOS, run() is one RTOS task
+ * (Rtos::start()) that blocks on a semaphore instead, given by post().
+ * 
+ * All functions except post() must be called from thread context.
+ */
+class Scheduler {
+public:
+    /**
+     * @brief Task handler function type
+     */
+    using Handler = void (*)(void* context);
+
+    /**
+     * @brief Task control block
+     * 
+     * Set handler/context before starting the task; all other fields
+     * are owned by the scheduler.
+     */
+    struct Task {
+        Handler     handler   = nullptr;
+        void*       context   = nullptr;
+
+        // Internal state
+        u32         periodMs  = 0;          ///< 0 for one-shot tasks
+        u32         deadline  = 0;          ///< Timer expiry tick
+        u32         readyAt   = 0;          ///< Ready queue ordering key
+        bool        inWheel   = false;
+        bool        inReady   = false;
+        volatile bool posted  = false;
+        u8          profile   = 0;          ///< Profiler slot (Profiler::attach())
+        Task*       wheelNext = nullptr;
+        Task*       readyNext = nullptr;
+        Task*       postNext  = nullptr;
+    };
+
+    /**
+     * @brief Initialize the scheduler
+     * 
+     * Call once after System::init().
+     */
+    static void init();
+
+    /**
+     * @brief Start a periodic task
+     * @param task Task to start
+     * @param periodMs Period in milliseconds
+     * @param delayMs Delay before the first run
+     * @return Status::Ok on success, Status::Busy if the task is already running
+     */
+    static Status startPeriodic(Task* task, u32 periodMs, u32 delayMs = 0);
+
+    /**
+     * @brief Run a task once after a delay
+     * @param task Task to start
+     * @param delayMs Delay in milliseconds
+     * @return Status::Ok on success, Status::Busy if the task is already running
+     */
+    static Status startOnce(Task* task, u32 delayMs);
+
+    /**
+     * @brief Stop a task and drop any pending run
+     * @param task Task to cancel
+     */
+    static void cancel(Task* task);
+
+    /**
+     * @brief Make a task ready from interrupt context
+     * 
+     * Safe to call from any ISR. Posting an already-posted task has no
+     * further effect until it has run.
+     * 
+     * @param task Task to run
+     */
+    static void post(Task* task);
+
+    /**
+     * @brief Dispatch the most urgent ready task
+     * @return true if a task was run
+     */
+    static bool dispatch();
+
+    /**
+     * @brief Run the dispatch loop forever
+     * 
+     * Sleeps whenever no task is ready.
+     */
+    [[noreturn]] static void run();
+
+private:
+    static Task*            s_wheel[SCHEDULER_WHEEL_SLOTS];
+    static u32              s_wheelTick;    ///< Next tick to be processed
+    static Task*            s_ready;
+    static Task* volatile   s_posted;
+#if USE_RTOS
+    static Semaphore        s_wakeSignal;   ///< Given by post()
+#endif
+
+    static void advance(u32 now);
+    static void drainPosted(u32 now);
+    static void insertWheel(Task* task);
+    static void removeWheel(Task* task);
+    static void makeReady(Task* task, u32 readyAt);
+    static void removeReady(Task* task);
+    static u32 nextDeadline();
+    static Status start(Task* task, u32 periodMs, u32 delayMs);
+};
+
+} // namespace embedded
+
+#endif // SCHEDULER_HPP
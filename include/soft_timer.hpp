@@ -0,0 +1,171 @@
+/**
+ * @file soft_timer.hpp
+ * @brief Software timers driven from SysTick
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#ifndef SOFT_TIMER_HPP
+#define SOFT_TIMER_HPP
+
+#include "types.hpp"
+#include "config.hpp"
+#include "system.hpp"
+
+namespace embedded {
+
+/**
+ * @class SoftTimer
+ * @brief One-shot and periodic timers on the 64-bit tick count
+ *
+ * Running timers are kept in a list sorted by expiry tick, so each
+ * SysTick only compares the head against the current tick and pops
+ * what has expired: O(1) per tick plus O(1) per expiring timer.
+ * Starting a timer is a sorted insert. Expiries are 64-bit tick
+ * counts and never wrap; after a tickless sleep SysTick catches up
+ * on everything that expired meanwhile.
+ *
+ * Callbacks run in SysTick context (IrqPriority::High) and must be
+ * short; post a Scheduler task for real work. Timers are statically
+ * allocated by the caller. All functions are safe from any context.
+ */
+class SoftTimer {
+public:
+    /**
+     * @brief Expiry callback type
+     */
+    using Callback = void (*)(void* context);
+
+    /**
+     * @brief Drop all running timers
+     *
+     * Called by System::init() before SysTick starts.
+     */
+    static void init();
+
+    /**
+     * @brief Timer control block
+     *
+     * Set callback/context before starting the timer; all other fields
+     * are owned by SoftTimer.
+     */
+    struct Timer {
+        Callback    callback = nullptr;
+        void*       context  = nullptr;
+
+        // Internal state
+        u64         expiry   = 0;           ///< Tick at which the timer fires
+        u32         periodMs = 0;           ///< 0 for one-shot timers
+        bool        active   = false;
+        Timer*      next     = nullptr;
+    };
+
+    /**
+     * @brief Fire a timer once after a delay
+     * @param timer Timer to start
+     * @param delayMs Delay in milliseconds (0 fires on the next tick)
+     * @return Status::Ok on success, Status::Busy if the timer is running
+     */
+    static Status startOnce(Timer* timer, u32 delayMs);
+
+    /**
+     * @brief Fire a timer every period
+     *
+     * The first expiry is one period from now. Periods missed entirely
+     * (long critical sections) are skipped, keeping the phase.
+     *
+     * @param timer Timer to start
+     * @param periodMs Period in milliseconds
+     * @return Status::Ok on success, Status::Busy if the timer is running
+     */
+    static Status startPeriodic(Timer* timer, u32 periodMs);
+
+    /**
+     * @brief Stop a timer
+     *
+     * Stopping an expired or stopped timer has no effect. Called from
+     * an interrupt that preempted SysTick, the callback may still run
+     * once if it was about to.
+     *
+     * @param timer Timer to stop
+     */
+    static void stop(Timer* timer);
+
+    /**
+     * @brief Check whether a timer is running
+     * @param timer Timer to check
+     * @return true until a one-shot timer fires or the timer is stopped
+     */
+    static bool isActive(const Timer* timer);
+
+    /**
+     * @brief Get the tick of the earliest expiry
+     *
+     * Used by the scheduler to bound tickless sleeps.
+     *
+     * @param tick Receives the expiry as a getTicks() value, at most
+     *        2^31 - 1 ticks ahead
+     * @return false if no timer is running
+     */
+    static bool getNextExpiry(u32& tick);
+
+private:
+    friend void ::SysTick_Handler(void);
+
+    static Timer* s_head;
+
+    static Status start(Timer* timer, u32 periodMs, u32 delayMs);
+    static void insert(Timer* timer);
+
+    /**
+     * @brief Fire all timers due at a tick (from SysTick_Handler)
+     * @param now Current getTicks64() value
+     */
+    static void process(u64 now);
+};
+
+/**
+ * @class Deadline
+ * @brief Wrap-free timeout check on the 64-bit tick count
+ *
+ * Replaces hand-written `(getTicks() - start) < ms` arithmetic in
+ * polling loops:
+ *
+ *     Deadline deadline(timeoutMs);
+ *     while (!ready()) {
+ *         if (deadline.expired()) return Status::Timeout;
+ *     }
+ */
+class Deadline {
+public:
+    /**
+     * @brief Start a deadline
+     * @param ms Milliseconds from now
+     */
+    explicit Deadline(u32 ms) : m_expiry(System::getTicks64() + ms) {}
+
+    /**
+     * @brief Check whether the deadline has passed
+     * @return true once the tick count has advanced by ms
+     */
+    bool expired() const {
+        return System::getTicks64() >= m_expiry;
+    }
+
+    /**
+     * @brief Get the time left
+     * @return Milliseconds until expiry (0 once expired)
+     */
+    u32 remaining() const {
+        u64 now = System::getTicks64();
+        return (now >= m_expiry) ? 0 : static_cast<u32>(m_expiry - now);
+    }
+
+private:
+    u64 m_expiry;
+};
+
+} // namespace embedded
+
+#endif // SOFT_TIMER_HPP
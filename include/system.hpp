@@ -12,8 +12,108 @@
 #include "types.hpp"
 #include "config.hpp"
 
+extern "C" void SysTick_Handler(void);
+
 namespace embedded {
 
+/**
+ * @brief Interrupt numbers (STM32F407)
+ * 
+ * Negative values are Cortex-M system exceptions, whose priority lives
+ * in the SCB SHPR registers; they cannot be enabled or pended through
+ * the NVIC.
+ */
+enum class IrqNumber : i16 {
+    MemManage       = -12,
+    BusFault        = -11,
+    UsageFault      = -10,
+    SVCall          = -5,
+    DebugMon        = -4,
+    PendSV          = -2,
+    SysTick         = -1,
+
+    WWDG            = 0,
+    PVD             = 1,
+    TampStamp       = 2,
+    RtcWakeup       = 3,
+    Flash           = 4,
+    Rcc             = 5,
+    Exti0           = 6,
+    Exti1           = 7,
+    Exti2           = 8,
+    Exti3           = 9,
+    Exti4           = 10,
+    Dma1Stream0     = 11,
+    Dma1Stream1     = 12,
+    Dma1Stream2     = 13,
+    Dma1Stream3     = 14,
+    Dma1Stream4     = 15,
+    Dma1Stream5     = 16,
+    Dma1Stream6     = 17,
+    Adc             = 18,
+    Exti9_5         = 23,
+    Tim1BrkTim9     = 24,
+    Tim1UpTim10     = 25,
+    Tim1TrgComTim11 = 26,
+    Tim1Cc          = 27,
+    Tim2            = 28,
+    Tim3            = 29,
+    Tim4            = 30,
+    I2c1Ev          = 31,
+    I2c1Er          = 32,
+    I2c2Ev          = 33,
+    I2c2Er          = 34,
+    Spi1            = 35,
+    Spi2            = 36,
+    Usart1          = 37,
+    Usart2          = 38,
+    Usart3          = 39,
+    Exti15_10       = 40,
+    Dma1Stream7     = 47,
+    Tim5            = 50,
+    Spi3            = 51,
+    Uart4           = 52,
+    Uart5           = 53,
+    Tim6Dac         = 54,
+    Tim7            = 55,
+    Dma2Stream0     = 56,
+    Dma2Stream1     = 57,
+    Dma2Stream2     = 58,
+    Dma2Stream3     = 59,
+    Dma2Stream4     = 60,
+    Dma2Stream5     = 68,
+    Dma2Stream6     = 69,
+    Dma2Stream7     = 70,
+    Usart6          = 71,
+    I2c3Ev          = 72,
+    I2c3Er          = 73
+};
+
+/**
+ * @brief Clock tree profiles (see System::setClockProfile())
+ * 
+ * All profiles keep APB1 <= 42 MHz and APB2 <= 84 MHz.
+ */
+enum class ClockProfile : u8 {
+    Performance = 0,    ///< PLL, HCLK = SYSTEM_CLOCK_HZ, APB1 /4, APB2 /2 (boot profile)
+    Balanced    = 1,    ///< PLL, HCLK = SYSTEM_CLOCK_HZ / 2, APB1 /2, APB2 /1
+    LowPower    = 2     ///< HSI 16 MHz, PLL and HSE stopped, APB1 = APB2 = HCLK
+};
+
+/**
+ * @brief Clock change notification (System::addClockListener())
+ * 
+ * Intrusive list node owned by the driver; it must stay valid until
+ * removed again.
+ */
+struct ClockListener {
+    using Callback = void (*)(void* context);
+
+    Callback        callback = nullptr;     ///< Called after every profile switch
+    void*           context  = nullptr;     ///< Passed to callback
+    ClockListener*  next     = nullptr;     ///< Managed by System
+};
+
 /**
  * @class System
  * @brief Core system management class
@@ -33,6 +133,25 @@ public:
      */
     static Status init();
 
+    /**
+     * @brief Start HSE and the flash accelerator (boot step 1)
+     * 
+     * Called by Reset_Handler before memory init so the crystal starts
+     * up while .data and .bss are being initialized. Touches registers
+     * only, never RAM-resident state.
+     */
+    static void startClocks();
+
+    /**
+     * @brief Start the PLL (boot step 2)
+     * 
+     * Called by Reset_Handler after memory init. Waits for HSE (falling
+     * back to HSI after CLOCK_HSE_TIMEOUT polls) and turns the PLL on
+     * without waiting for lock; init() completes the switch. Touches
+     * registers only.
+     */
+    static void startPll();
+
     /**
      * @brief Reset the system
      */
@@ -40,28 +159,127 @@ public:
 
     /**
      * @brief Get system tick count
+     * 
+     * Wraps after ~49.7 days; compare with wrap-safe differences, or
+     * use getTicks64() / Deadline.
+     * 
      * @return Current tick count in milliseconds
      */
     static u32 getTicks();
 
+    /**
+     * @brief Get 64-bit system tick count
+     * 
+     * Lock-free and tear-free from any context: never wraps in
+     * practice (~585 million years).
+     * 
+     * @return Milliseconds since init()
+     */
+    static u64 getTicks64();
+
     /**
      * @brief Delay execution for specified milliseconds
+     * 
+     * With USE_RTOS, called from a task once the kernel runs, this is
+     * vTaskDelay(): the task blocks and other tasks run meanwhile.
+     * 
      * @param ms Delay duration in milliseconds
      */
     static void delayMs(u32 ms);
 
     /**
      * @brief Delay execution for specified microseconds
+     * 
+     * Busy-waits on the DWT cycle counter, so the delay is independent
+     * of optimization level and flash wait states.
+     * 
      * @param us Delay duration in microseconds
      */
     static void delayUs(u32 us);
 
+    /**
+     * @brief Get raw DWT cycle counter
+     * 
+     * Wraps every 2^32 core cycles (~25.6 s at 168 MHz); differences of
+     * two readings are valid across one wrap.
+     * 
+     * @return Current core cycle count
+     */
+    static u32 getCycles();
+
+    /**
+     * @brief Get 64-bit cycle count since init()
+     * @return Wrap-extended core cycle count
+     */
+    static u64 getCycles64();
+
+    /**
+     * @brief Get microseconds since init()
+     * @return Wrap-safe 64-bit microsecond timestamp
+     */
+    static u64 getMicros();
+
     /**
      * @brief Get system clock frequency
-     * @return System clock frequency in Hz
+     * @return Current core (HCLK) frequency in Hz
      */
     static u32 getSystemClock();
 
+    /**
+     * @brief Get APB1 peripheral clock frequency
+     * @return Current PCLK1 in Hz (timers on APB1 run at twice this
+     *         when the bus is divided)
+     */
+    static u32 getApb1Clock();
+
+    /**
+     * @brief Get APB2 peripheral clock frequency
+     * @return Current PCLK2 in Hz
+     */
+    static u32 getApb2Clock();
+
+    /**
+     * @brief Switch the clock tree to another profile
+     * 
+     * Raises the flash latency before the clock goes up and lowers it
+     * only afterwards, reprograms SysTick for the new HCLK (the running
+     * tick restarts, so one tick may stretch by up to a period) and
+     * keeps getMicros() continuous. Listeners are notified after the
+     * switch, in the calling context; drivers recompute their baud
+     * rates and prescalers there. Transfers in flight during the switch
+     * run at the old rate until the listener reprograms the peripheral,
+     * so switch between transfers.
+     * 
+     * Thread context only.
+     * 
+     * @param profile Target profile
+     * @return Status::Ok, Status::InvalidArg for an unknown profile, or
+     *         Status::Timeout if the PLL failed to lock (the clock is
+     *         left unchanged)
+     */
+    static Status setClockProfile(ClockProfile profile);
+
+    /**
+     * @brief Get the active clock profile
+     * @return Current profile (Performance after init())
+     */
+    static ClockProfile getClockProfile();
+
+    /**
+     * @brief Register for clock profile changes
+     * 
+     * Adding a listener that is already registered has no effect.
+     * 
+     * @param listener Listener with callback set
+     */
+    static void addClockListener(ClockListener* listener);
+
+    /**
+     * @brief Unregister a clock listener
+     * @param listener Previously added listener (ignored if not registered)
+     */
+    static void removeClockListener(ClockListener* listener);
+
     /**
      * @brief Enter low power sleep mode
      */
@@ -72,6 +290,79 @@ public:
      */
     static void deepSleep();
 
+    /**
+     * @brief Sleep until a tick deadline or the next interrupt
+     * 
+     * With LOW_POWER_MODE enabled, SysTick is stopped and reprogrammed
+     * to fire at @p wakeTick (bounded by the 24-bit reload range), the
+     * core sleeps, and the tick count is compensated for the skipped
+     * periods on wake-up, whether the deadline was reached or another
+     * interrupt woke the core early. Without LOW_POWER_MODE this is a
+     * plain sleep() woken by the next tick.
+     * 
+     * May be called with interrupts disabled; pending interrupts still
+     * wake the core and run once they are re-enabled.
+     * 
+     * @param wakeTick Tick count at which to resume
+     */
+    static void idleUntil(u32 wakeTick);
+
+    /**
+     * @brief Enable an interrupt in the NVIC
+     * @param irq Peripheral interrupt (>= 0)
+     */
+    static void enableIrq(IrqNumber irq);
+
+    /**
+     * @brief Disable an interrupt in the NVIC
+     * 
+     * Completes before returning (DSB/ISB), so the handler cannot run
+     * afterwards.
+     * 
+     * @param irq Peripheral interrupt (>= 0)
+     */
+    static void disableIrq(IrqNumber irq);
+
+    /**
+     * @brief Check whether an interrupt is enabled
+     * @param irq Peripheral interrupt (>= 0)
+     * @return true if enabled
+     */
+    static bool isIrqEnabled(IrqNumber irq);
+
+    /**
+     * @brief Set interrupt preemption priority
+     * @param irq Peripheral interrupt or system exception
+     * @param priority Priority level
+     */
+    static void setIrqPriority(IrqNumber irq, IrqPriority priority);
+
+    /**
+     * @brief Get raw interrupt priority register value
+     * @param irq Peripheral interrupt or system exception
+     * @return Priority value (upper 4 bits significant)
+     */
+    static u8 getIrqPriority(IrqNumber irq);
+
+    /**
+     * @brief Set an interrupt pending (software trigger)
+     * @param irq Peripheral interrupt (>= 0)
+     */
+    static void setIrqPending(IrqNumber irq);
+
+    /**
+     * @brief Clear a pending interrupt
+     * @param irq Peripheral interrupt (>= 0)
+     */
+    static void clearIrqPending(IrqNumber irq);
+
+    /**
+     * @brief Check whether an interrupt is pending
+     * @param irq Peripheral interrupt (>= 0)
+     * @return true if pending
+     */
+    static bool isIrqPending(IrqNumber irq);
+
     /**
      * @brief Get unique device ID
      * @param id Pointer to array to store 96-bit ID (3 x u32)
@@ -93,9 +384,26 @@ public:
     static Status disablePeripheralClock(u32 peripheral);
 
 private:
+    friend void ::SysTick_Handler(void);
+
     static volatile u32 s_tickCount;
+    static volatile u32 s_tickHigh;     ///< Upper word of getTicks64()
+    static u32 s_cycleHigh;             ///< Upper word of getCycles64()
+    static u32 s_cycleLast;             ///< CYCCNT at the last extension
+
+    static ClockProfile s_clockProfile;
+    static u32 s_systemClock;           ///< HCLK in Hz
+    static u32 s_apb1Clock;             ///< PCLK1 in Hz
+    static u32 s_apb2Clock;             ///< PCLK2 in Hz
+    static u32 s_cyclesPerUs;
+    static u64 s_microsBase;            ///< getMicros() at the last switch
+    static u64 s_cyclesBase;            ///< getCycles64() at the last switch
+    static ClockListener* s_clockListeners;
     
+    static void advanceTicks(u32 ticks);
     static void initClocks();
+    static void applyClockProfile(ClockProfile profile);
+    static void initDwt();
     static void initSysTick();
     static void initNvic();
 };
@@ -72,6 +72,16 @@ enum class IrqPriority : u8 {
     Lowest  = 4
 };
 
+/**
+ * @brief Convert a priority level to the NVIC/BASEPRI register value
+ * 
+ * Levels are spread over the 4 implemented preemption bits (0x00, 0x30,
+ * ... 0xC0), leaving the least urgent values for PendSV-style handlers.
+ */
+constexpr u8 irqPriorityValue(IrqPriority priority) {
+    return static_cast<u8>((static_cast<u8>(priority) * 3) << 4);
+}
+
 /*============================================================================
  * Utility Macros
  *===========================================================================*/
@@ -85,6 +95,51 @@ enum class IrqPriority : u8 {
 
 #define UNUSED(x)               ((void)(x))
 
+#if EMBEDDED_HOST_BUILD
+
+/*============================================================================
+ * Host Simulation (sim/)
+ *===========================================================================*/
+namespace sim {
+u32  getPrimask();
+void setPrimask(u32 primask);
+u32  getBasepri();
+void setBasepri(u32 basepri);
+} // namespace sim
+
+#define DMB()                   __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define DSB()                   __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define ISB()                   __atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+#define CCM_DATA
+#define CCM_BSS
+#define RAM_FUNC
+#define NOINIT
+
+inline u32 disableInterrupts() {
+    u32 primask = sim::getPrimask();
+    sim::setPrimask(1);
+    return primask;
+}
+
+inline void restoreInterrupts(u32 primask) {
+    sim::setPrimask(primask);
+}
+
+inline u32 raiseBasepri(u8 value) {
+    u32 basepri = sim::getBasepri();
+    if (value != 0 && (basepri == 0 || value < basepri)) {
+        sim::setBasepri(value);
+    }
+    return basepri;
+}
+
+inline void restoreBasepri(u32 basepri) {
+    sim::setBasepri(basepri);
+}
+
+#else
+
 /*============================================================================
  * Memory Barrier Macros
  *===========================================================================*/
@@ -92,6 +147,22 @@ enum class IrqPriority : u8 {
 #define DSB()                   __asm volatile ("dsb" ::: "memory")
 #define ISB()                   __asm volatile ("isb" ::: "memory")
 
+/*============================================================================
+ * Memory Placement Macros
+ *===========================================================================*/
+/// Initialized data in CCM RAM (zero wait state, not DMA accessible)
+#define CCM_DATA                __attribute__((section(".ccmram")))
+
+/// Zero-initialized data in CCM RAM (stacks, buffers, control state)
+#define CCM_BSS                 __attribute__((section(".ccmbss")))
+
+/// Function executed from SRAM, avoiding flash wait states
+#define RAM_FUNC                __attribute__((section(".ramfunc"), noinline, long_call))
+
+/// Data left untouched by Reset_Handler, kept across warm resets
+/// (garbage after power-on: validate with a magic value)
+#define NOINIT                  __attribute__((section(".noinit")))
+
 /*============================================================================
  * Critical Section Helpers
  *===========================================================================*/
@@ -106,20 +177,60 @@ inline void restoreInterrupts(u32 primask) {
     __asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
 }
 
+inline u32 raiseBasepri(u8 value) {
+    u32 basepri;
+    __asm volatile ("mrs %0, basepri" : "=r" (basepri));
+    // basepri_max only ever raises the masking level
+    __asm volatile ("msr basepri_max, %0" :: "r" (static_cast<u32>(value)) : "memory");
+    return basepri;
+}
+
+inline void restoreBasepri(u32 basepri) {
+    __asm volatile ("msr basepri, %0" :: "r" (basepri) : "memory");
+}
+
+#endif // EMBEDDED_HOST_BUILD
+
 /*============================================================================
  * RAII Critical Section Guard
  *===========================================================================*/
 class CriticalSection {
 public:
-    CriticalSection() : m_primask(disableInterrupts()) {}
-    ~CriticalSection() { restoreInterrupts(m_primask); }
+    /**
+     * @brief Mask all interrupts (PRIMASK)
+     */
+    CriticalSection() : m_saved(disableInterrupts()), m_basepri(false) {}
+
+    /**
+     * @brief Mask only interrupts at @p ceiling priority or less urgent
+     * 
+     * Uses BASEPRI, so more urgent handlers keep running. The ceiling
+     * must be at least as urgent as every handler touching the guarded
+     * data. IrqPriority::Highest cannot be expressed with BASEPRI and
+     * falls back to PRIMASK.
+     * 
+     * @param ceiling Most urgent priority to mask
+     */
+    explicit CriticalSection(IrqPriority ceiling)
+        : m_basepri(ceiling != IrqPriority::Highest) {
+        m_saved = m_basepri ? raiseBasepri(irqPriorityValue(ceiling)) : disableInterrupts();
+    }
+
+    ~CriticalSection() {
+        if (m_basepri) {
+            restoreBasepri(m_saved);
+        } else {
+            restoreInterrupts(m_saved);
+        }
+    }
     
     // Non-copyable
     CriticalSection(const CriticalSection&) = delete;
     CriticalSection& operator=(const CriticalSection&) = delete;
 
 private:
-    u32 m_primask;
+    u32  m_saved;
+    bool m_basepri;
 };
 
 } // namespace embedded
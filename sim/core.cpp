@@ -0,0 +1,239 @@
+/**
+ * @file core.cpp
+ * @brief Simulated Cortex-M core: interrupt masking, NVIC and time
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "sim/sim.hpp"
+
+namespace embedded {
+namespace sim {
+
+void resetGpio();
+void resetUart();
+void resetItm();
+
+namespace {
+
+constexpr i16 FIRST_IRQ       = -16;
+constexpr u32 IRQ_COUNT       = 16 + 82;        ///< Exceptions + STM32F407 interrupts
+constexpr u32 THREAD_PRIORITY = 0x100;          ///< Below every configurable level
+
+struct Irq {
+    IrqHandler  handler;
+    u8          priority;
+    bool        enabled;
+    bool        pending;
+    bool        active;
+};
+
+Irq s_irqs[IRQ_COUNT];
+u32 s_primask;
+u32 s_basepri;
+u32 s_depth;                        ///< Nested handlers running
+u32 s_executionPriority = THREAD_PRIORITY;
+
+u64 s_cycles;
+u64 s_nextTick;
+u64 s_cyclesPerTick = SYSTEM_CLOCK_HZ / TICK_RATE_HZ;
+bool s_sysTick;
+
+inline Irq& irqState(IrqNumber irq) {
+    return s_irqs[static_cast<i16>(irq) - FIRST_IRQ];
+}
+
+inline bool isException(u32 index) {
+    return index < 16;
+}
+
+/**
+ * Most urgent pending interrupt allowed to preempt the current
+ * execution priority under PRIMASK/BASEPRI, or IRQ_COUNT if none.
+ */
+u32 nextIrq() {
+    if (s_primask != 0) {
+        return IRQ_COUNT;
+    }
+
+    u32 best = IRQ_COUNT;
+    u32 bestPriority = s_executionPriority;
+    if (s_basepri != 0 && s_basepri < bestPriority) {
+        bestPriority = s_basepri;
+    }
+
+    for (u32 i = 0; i < IRQ_COUNT; i++) {
+        const Irq& irq = s_irqs[i];
+        if (!irq.pending || irq.active || irq.handler == nullptr) {
+            continue;
+        }
+        if (!isException(i) && !irq.enabled) {
+            continue;
+        }
+        if (irq.priority < bestPriority) {
+            best = i;
+            bestPriority = irq.priority;
+        }
+    }
+    return best;
+}
+
+/**
+ * Run every deliverable handler. Handlers nest: raising a more urgent
+ * interrupt inside a handler runs it before the outer one returns.
+ */
+void deliver() {
+    while (true) {
+        u32 index = nextIrq();
+        if (index == IRQ_COUNT) {
+            return;
+        }
+
+        Irq& irq = s_irqs[index];
+        u32 savedPriority = s_executionPriority;
+        irq.pending = false;
+        irq.active = true;
+        s_executionPriority = irq.priority;
+        s_depth++;
+
+        irq.handler();
+
+        s_depth--;
+        s_executionPriority = savedPriority;
+        irq.active = false;
+    }
+}
+
+} // namespace
+
+/*============================================================================
+ * Interrupt Masking (types.hpp)
+ *===========================================================================*/
+u32 getPrimask() {
+    return s_primask;
+}
+
+void setPrimask(u32 primask) {
+    s_primask = primask & 1;
+    if (s_primask == 0) {
+        deliver();
+    }
+}
+
+u32 getBasepri() {
+    return s_basepri;
+}
+
+void setBasepri(u32 basepri) {
+    u32 previous = s_basepri;
+    s_basepri = basepri & 0xF0;
+    if (s_basepri == 0 || (previous != 0 && s_basepri > previous)) {
+        deliver();
+    }
+}
+
+/*============================================================================
+ * NVIC
+ *===========================================================================*/
+void reset() {
+    for (Irq& irq : s_irqs) {
+        irq = Irq();
+    }
+    s_primask = 0;
+    s_basepri = 0;
+    s_depth = 0;
+    s_executionPriority = THREAD_PRIORITY;
+
+    s_cycles = 0;
+    s_cyclesPerTick = SYSTEM_CLOCK_HZ / TICK_RATE_HZ;
+    s_nextTick = s_cyclesPerTick;
+    s_sysTick = false;
+
+    resetGpio();
+    resetUart();
+    resetItm();
+}
+
+void setIrqHandler(IrqNumber irq, IrqHandler handler) {
+    irqState(irq).handler = handler;
+}
+
+void raiseIrq(IrqNumber irq) {
+    setIrqPending(irq, true);
+}
+
+bool inInterrupt() {
+    return s_depth != 0;
+}
+
+void setIrqEnabled(IrqNumber irq, bool enable) {
+    irqState(irq).enabled = enable;
+    if (enable) {
+        deliver();
+    }
+}
+
+bool isIrqEnabled(IrqNumber irq) {
+    return static_cast<i16>(irq) < 0 || irqState(irq).enabled;
+}
+
+void setIrqPending(IrqNumber irq, bool pending) {
+    irqState(irq).pending = pending;
+    if (pending) {
+        deliver();
+    }
+}
+
+bool isIrqPending(IrqNumber irq) {
+    return irqState(irq).pending;
+}
+
+void setIrqPriority(IrqNumber irq, u8 value) {
+    irqState(irq).priority = static_cast<u8>(value & 0xF0);
+    deliver();
+}
+
+u8 getIrqPriority(IrqNumber irq) {
+    return irqState(irq).priority;
+}
+
+/*============================================================================
+ * Virtual Time
+ *===========================================================================*/
+void advance(u32 ms) {
+    advanceCycles(static_cast<u64>(ms) * s_cyclesPerTick);
+}
+
+void advanceCycles(u64 cycles) {
+    u64 target = s_cycles + cycles;
+
+    // Like the hardware, ticks raised while SysTick is still pending merge
+    while (s_sysTick && s_nextTick <= target) {
+        s_cycles = s_nextTick;
+        s_nextTick += s_cyclesPerTick;
+        raiseIrq(IrqNumber::SysTick);
+    }
+
+    s_cycles = target;
+}
+
+u64 getCycles() {
+    return s_cycles;
+}
+
+void setCoreClock(u32 hz) {
+    // Like a SysTick reload, the running tick restarts
+    s_cyclesPerTick = hz / TICK_RATE_HZ;
+    s_nextTick = s_cycles + s_cyclesPerTick;
+}
+
+void enableSysTick(bool enable) {
+    if (enable && !s_sysTick) {
+        s_nextTick = s_cycles + s_cyclesPerTick;
+    }
+    s_sysTick = enable;
+}
+
+} // namespace sim
+} // namespace embedded
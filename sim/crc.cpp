@@ -0,0 +1,43 @@
+/**
+ * @file crc.cpp
+ * @brief CRC unit on the simulated core
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ *
+ * The simulated unit is the software tables: results are identical to
+ * the target, and a DMA feed completes before crc32WordsDma() returns.
+ */
+
+#include "hal/crc.hpp"
+
+namespace embedded {
+namespace hal {
+
+Status Crc::init() {
+    return Status::Ok;
+}
+
+u32 Crc::crc32(const void* data, size_t length, u32 crc) {
+    return crc32Soft(data, length, crc);
+}
+
+u32 Crc::crc32Words(const u32* words, size_t count, u32 crc) {
+    return crc32WordsSoft(words, count, crc);
+}
+
+Status Crc::crc32WordsDma(const u32* words, size_t count, Callback callback,
+                          void* context, u32 crc) {
+    if (words == nullptr || callback == nullptr) {
+        return Status::InvalidArg;
+    }
+    callback(Status::Ok, crc32WordsSoft(words, count, crc), context);
+    return Status::Ok;
+}
+
+bool Crc::isBusy() {
+    return false;
+}
+
+} // namespace hal
+} // namespace embedded
@@ -0,0 +1,330 @@
+/**
+ * @file gpio.cpp
+ * @brief GPIO implementation on simulated port registers
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ *
+ * Pin interrupts follow the EXTI model: one line per pin number shared
+ * by all ports, raised on the line's NVIC vector, so callbacks respect
+ * critical sections and priorities like on the target.
+ */
+
+#include "hal/gpio.hpp"
+#include "sim/sim.hpp"
+#include "profiler.hpp"
+
+namespace embedded {
+namespace sim {
+
+namespace {
+
+constexpr u32 PORT_BASE   = 0x40020000;
+constexpr u32 PORT_STRIDE = 0x400;
+constexpr u32 PORT_COUNT  = 9;              ///< GPIOA-GPIOI
+constexpr u8  NO_PORT     = 0xFF;
+
+struct Line {
+    hal::GPIO::Callback callback;
+    void*               context;
+    hal::GPIO::Trigger  trigger;
+    u8                  port;
+};
+
+GpioRegisters s_ports[PORT_COUNT];
+u16 s_inputs[PORT_COUNT];                   ///< Externally driven levels
+Line s_lines[16];
+u16 s_pendingLines;
+
+inline u32 portIndex(const GpioRegisters* port) {
+    return static_cast<u32>(port - s_ports);
+}
+
+inline u16 outputMask(const GpioRegisters* port) {
+    u32 moder = port->moder;
+    u16 mask = 0;
+    for (u8 pin = 0; pin < 16; pin++) {
+        if (((moder >> (pin * 2)) & 0x3) == 0x1) {
+            mask = static_cast<u16>(mask | BIT(pin));
+        }
+    }
+    return mask;
+}
+
+void updateIdr(GpioRegisters* port) {
+    u16 outputs = outputMask(port);
+    u32 odr = port->odr;
+    port->idr = (odr & outputs) | (s_inputs[portIndex(port)] & ~outputs & 0xFFFF);
+}
+
+inline IrqNumber lineIrq(u8 pin) {
+    if (pin <= 4) {
+        return static_cast<IrqNumber>(static_cast<i16>(IrqNumber::Exti0) + pin);
+    }
+    return (pin <= 9) ? IrqNumber::Exti9_5 : IrqNumber::Exti15_10;
+}
+
+void dispatchLines(u16 mask) {
+    PROFILE_ISR(Exti);
+    u16 pending = s_pendingLines & mask;
+    s_pendingLines = static_cast<u16>(s_pendingLines & ~pending);
+    while (pending != 0) {
+        u8 pin = static_cast<u8>(__builtin_ctz(pending));
+        pending = static_cast<u16>(pending & (pending - 1));
+        const Line& line = s_lines[pin];
+        if (line.callback != nullptr) {
+            line.callback(line.context);
+        }
+    }
+}
+
+void exti0()     { dispatchLines(0x0001); }
+void exti1()     { dispatchLines(0x0002); }
+void exti2()     { dispatchLines(0x0004); }
+void exti3()     { dispatchLines(0x0008); }
+void exti4()     { dispatchLines(0x0010); }
+void exti9_5()   { dispatchLines(0x03E0); }
+void exti15_10() { dispatchLines(0xFC00); }
+
+IrqHandler lineHandler(u8 pin) {
+    static const IrqHandler handlers[] = { exti0, exti1, exti2, exti3, exti4 };
+    if (pin <= 4) {
+        return handlers[pin];
+    }
+    return (pin <= 9) ? exti9_5 : exti15_10;
+}
+
+} // namespace
+
+void resetGpio() {
+    for (u32 i = 0; i < PORT_COUNT; i++) {
+        GpioRegisters& port = s_ports[i];
+        port.moder = 0;
+        port.otyper = 0;
+        port.ospeedr = 0;
+        port.pupdr = 0;
+        port.idr = 0;
+        port.odr = 0;
+        port.bsrr = 0;
+        port.lckr = 0;
+        port.afr[0] = 0;
+        port.afr[1] = 0;
+        s_inputs[i] = 0;
+    }
+    for (Line& line : s_lines) {
+        line = Line();
+        line.port = NO_PORT;
+    }
+    s_pendingLines = 0;
+}
+
+GpioRegisters* gpioPort(u32 base) {
+    u32 offset = base - PORT_BASE;
+    if (base < PORT_BASE || offset % PORT_STRIDE != 0 || offset / PORT_STRIDE >= PORT_COUNT) {
+        return nullptr;
+    }
+    return &s_ports[offset / PORT_STRIDE];
+}
+
+void syncGpio(const volatile void* reg) {
+    const volatile u8* address = static_cast<const volatile u8*>(reg);
+    const volatile u8* first = reinterpret_cast<const volatile u8*>(&s_ports[0]);
+    size_t offset = static_cast<size_t>(address - first);
+    if (address < first || offset >= sizeof(s_ports)) {
+        return;
+    }
+
+    GpioRegisters* port = &s_ports[offset / sizeof(GpioRegisters)];
+    u32 bsrr = port->bsrr;
+    if (bsrr != 0) {
+        // Set wins where a pin is both set and reset
+        port->odr = ((port->odr & ~(bsrr >> 16)) | (bsrr & 0xFFFF)) & 0xFFFF;
+        port->bsrr = 0;
+    }
+    updateIdr(port);
+}
+
+void setInput(GpioRegisters* port, u8 pin, bool high) {
+    u32 index = portIndex(port);
+    u16 mask = static_cast<u16>(BIT(pin));
+    bool wasHigh = (s_inputs[index] & mask) != 0;
+
+    s_inputs[index] = static_cast<u16>(high ? (s_inputs[index] | mask) : (s_inputs[index] & ~mask));
+    syncGpio(port);
+
+    const Line& line = s_lines[pin];
+    if (line.callback == nullptr || line.port != index || wasHigh == high) {
+        return;
+    }
+    u8 trigger = static_cast<u8>(line.trigger);
+    u8 edge = static_cast<u8>(high ? hal::GPIO::Trigger::Rising : hal::GPIO::Trigger::Falling);
+    if (trigger & edge) {
+        s_pendingLines = static_cast<u16>(s_pendingLines | mask);
+        raiseIrq(lineIrq(pin));
+    }
+}
+
+} // namespace sim
+
+namespace hal {
+
+namespace {
+
+sim::GpioRegisters* simPort(void* port) {
+    // Accept both hardware base addresses and GpioPort<>::base()
+    sim::GpioRegisters* mapped = sim::gpioPort(static_cast<u32>(reinterpret_cast<uintptr_t>(port)));
+    return mapped ? mapped : static_cast<sim::GpioRegisters*>(port);
+}
+
+} // namespace
+
+GPIO::GPIO(void* port, u8 pin)
+    : m_port(simPort(port))
+    , m_pin(pin)
+    , m_mode(Mode::Input) {
+}
+
+Status GPIO::setMode(Mode mode) {
+    if (m_pin > 15) {
+        return Status::InvalidArg;
+    }
+    sim::GpioRegisters* port = static_cast<sim::GpioRegisters*>(m_port);
+
+    u32 moder;
+    switch (mode) {
+        case Mode::Input:       moder = 0x0; break;
+        case Mode::Output:      moder = 0x1; break;
+        case Mode::OutputOD:    moder = 0x1; break;
+        case Mode::Alternate:   moder = 0x2; break;
+        case Mode::Analog:      moder = 0x3; break;
+        default:                return Status::InvalidArg;
+    }
+
+    port->moder = (port->moder & ~(0x3UL << (m_pin * 2))) | (moder << (m_pin * 2));
+    if (mode == Mode::OutputOD) {
+        port->otyper |= BIT(m_pin);
+    } else {
+        port->otyper &= ~BIT(m_pin);
+    }
+    m_mode = mode;
+    sim::syncGpio(port);
+    return Status::Ok;
+}
+
+Status GPIO::setPull(Pull pull) {
+    sim::GpioRegisters* port = static_cast<sim::GpioRegisters*>(m_port);
+    port->pupdr = (port->pupdr & ~(0x3UL << (m_pin * 2))) |
+                  (static_cast<u32>(pull) << (m_pin * 2));
+
+    // An undriven input settles to its pull level
+    sim::setInput(port, m_pin, pull == Pull::Up);
+    return Status::Ok;
+}
+
+Status GPIO::setSpeed(Speed speed) {
+    sim::GpioRegisters* port = static_cast<sim::GpioRegisters*>(m_port);
+    port->ospeedr = (port->ospeedr & ~(0x3UL << (m_pin * 2))) |
+                    (static_cast<u32>(speed) << (m_pin * 2));
+    return Status::Ok;
+}
+
+Status GPIO::setAlternateFunction(u8 af) {
+    if (af > 15) {
+        return Status::InvalidArg;
+    }
+    sim::GpioRegisters* port = static_cast<sim::GpioRegisters*>(m_port);
+    u32 shift = (m_pin % 8) * 4;
+    port->afr[m_pin / 8] = (port->afr[m_pin / 8] & ~(0xFUL << shift)) | (static_cast<u32>(af) << shift);
+    return Status::Ok;
+}
+
+void GPIO::setHigh() {
+    sim::GpioRegisters* port = static_cast<sim::GpioRegisters*>(m_port);
+    sim::syncGpio(port);
+    port->bsrr = BIT(m_pin);
+    sim::syncGpio(port);
+}
+
+void GPIO::setLow() {
+    sim::GpioRegisters* port = static_cast<sim::GpioRegisters*>(m_port);
+    sim::syncGpio(port);
+    port->bsrr = BIT(m_pin + 16);
+    sim::syncGpio(port);
+}
+
+void GPIO::toggle() {
+    sim::GpioRegisters* port = static_cast<sim::GpioRegisters*>(m_port);
+    sim::syncGpio(port);
+    u32 odr = port->odr;
+    port->bsrr = (odr & BIT(m_pin)) ? BIT(m_pin + 16) : BIT(m_pin);
+    sim::syncGpio(port);
+}
+
+void GPIO::write(PinState state) {
+    if (state == PinState::High) {
+        setHigh();
+    } else {
+        setLow();
+    }
+}
+
+PinState GPIO::read() const {
+    return isHigh() ? PinState::High : PinState::Low;
+}
+
+bool GPIO::isHigh() const {
+    sim::GpioRegisters* port = static_cast<sim::GpioRegisters*>(m_port);
+    sim::syncGpio(port);
+    return (port->idr & BIT(m_pin)) != 0;
+}
+
+bool GPIO::isLow() const {
+    return !isHigh();
+}
+
+Status GPIO::enableInterrupt(Trigger trigger, Callback callback, void* context,
+                             IrqPriority priority) {
+    if (m_pin > 15 || callback == nullptr) {
+        return Status::InvalidArg;
+    }
+
+    sim::Line& line = sim::s_lines[m_pin];
+    u8 index = static_cast<u8>(static_cast<sim::GpioRegisters*>(m_port) - sim::s_ports);
+    if (line.callback != nullptr && line.port != index) {
+        return Status::Busy;
+    }
+
+    line.callback = callback;
+    line.context = context;
+    line.trigger = trigger;
+    line.port = index;
+
+    IrqNumber irq = sim::lineIrq(m_pin);
+    sim::setIrqHandler(irq, sim::lineHandler(m_pin));
+    System::setIrqPriority(irq, priority);
+    System::enableIrq(irq);
+    return Status::Ok;
+}
+
+Status GPIO::disableInterrupt() {
+    sim::Line& line = sim::s_lines[m_pin];
+    u8 index = static_cast<u8>(static_cast<sim::GpioRegisters*>(m_port) - sim::s_ports);
+    if (line.port == index) {
+        line = sim::Line();
+        line.port = sim::NO_PORT;
+    }
+    return Status::Ok;
+}
+
+Status GPIO::lock() {
+    sim::GpioRegisters* port = static_cast<sim::GpioRegisters*>(m_port);
+    port->lckr |= BIT(m_pin) | BIT(16);
+    return Status::Ok;
+}
+
+void GPIO::configureExti(Trigger trigger) {
+    UNUSED(trigger);
+}
+
+} // namespace hal
+} // namespace embedded
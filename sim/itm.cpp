@@ -0,0 +1,93 @@
+/**
+ * @file itm.cpp
+ * @brief ITM stimulus ports on the simulated core
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ *
+ * Each port captures its bytes into sim::itmOutput(). As on the target,
+ * nothing is captured before Itm::init() enables the ports.
+ */
+
+#include "hal/itm.hpp"
+#include "sim/sim.hpp"
+
+namespace embedded {
+namespace sim {
+
+namespace {
+
+std::vector<u8> s_ports[32];
+u32             s_enabled;
+bool            s_busy;
+
+} // namespace
+
+void resetItm() {
+    for (std::vector<u8>& port : s_ports) {
+        port.clear();
+    }
+    s_enabled = 0;
+    s_busy = false;
+}
+
+std::vector<u8>& itmOutput(u8 port) {
+    return s_ports[port & 31];
+}
+
+void setItmBusy(bool busy) {
+    s_busy = busy;
+}
+
+} // namespace sim
+
+namespace hal {
+
+namespace {
+
+constexpr u32 PORT_MASK = BIT(ITM_PORT_LOG) | BIT(ITM_PORT_PROFILE) |
+                          (((1UL << ITM_DATA_CHANNELS) - 1) << ITM_PORT_DATA);
+
+} // namespace
+
+Status Itm::init(u32 swoBaudRate) {
+    if (swoBaudRate == 0 || swoBaudRate > System::getSystemClock()) {
+        return Status::InvalidArg;
+    }
+    sim::s_enabled = PORT_MASK;
+    return Status::Ok;
+}
+
+bool Itm::isEnabled(u8 port) {
+    return port < 32 && (sim::s_enabled & BIT(port)) != 0;
+}
+
+bool Itm::writeWord(u8 port, u32 word) {
+    if (!isEnabled(port) || sim::s_busy) {
+        return false;
+    }
+    std::vector<u8>& output = sim::s_ports[port];
+    for (u32 i = 0; i < 4; i++) {
+        output.push_back(static_cast<u8>(word >> (8 * i)));
+    }
+    return true;
+}
+
+bool Itm::writeByte(u8 port, u8 byte) {
+    if (!isEnabled(port) || sim::s_busy) {
+        return false;
+    }
+    sim::s_ports[port].push_back(byte);
+    return true;
+}
+
+size_t Itm::write(u8 port, const u8* data, size_t length) {
+    if (data == nullptr || !isEnabled(port) || sim::s_busy) {
+        return 0;
+    }
+    sim::s_ports[port].insert(sim::s_ports[port].end(), data, data + length);
+    return length;
+}
+
+} // namespace hal
+} // namespace embedded
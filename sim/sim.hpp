@@ -0,0 +1,236 @@
+/**
+ * @file sim.hpp
+ * @brief Host simulation backend (EMBEDDED_HOST_BUILD)
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ *
+ * Replaces the Cortex-M core and the peripherals the HAL touches
+ * directly, so drivers and middleware run unchanged on x86/Linux:
+ *
+ * - PRIMASK/BASEPRI and an NVIC model. Interrupts are delivered
+ *   synchronously, in priority order, as soon as nothing masks them.
+ * - Virtual time. The cycle counter and SysTick only advance through
+ *   advance()/advanceCycles() (and System::delay*), so runs are
+ *   deterministic and idle time costs nothing.
+ * - GPIO port register blocks with the STM32 layout, so GpioPin,
+ *   GpioPort and GPIO::Group operate on simulated memory.
+ * - UART transmission into a per-instance capture buffer.
+ *
+ * Everything is single threaded; "interrupt context" is a nested call.
+ */
+
+#ifndef SIM_SIM_HPP
+#define SIM_SIM_HPP
+
+#include "types.hpp"
+#include "system.hpp"
+
+#include <vector>
+
+namespace embedded {
+namespace sim {
+
+/*============================================================================
+ * Core and NVIC
+ *===========================================================================*/
+/**
+ * @brief Interrupt handler type
+ */
+using IrqHandler = void (*)();
+
+/**
+ * @brief Restore power-on state (time, NVIC, GPIO, UART captures)
+ */
+void reset();
+
+/**
+ * @brief Install the handler of an exception or interrupt
+ * @param irq Interrupt number
+ * @param handler Handler (nullptr removes it)
+ */
+void setIrqHandler(IrqNumber irq, IrqHandler handler);
+
+/**
+ * @brief Raise an interrupt as the peripheral would
+ *
+ * Runs the handler immediately if the interrupt is enabled, more urgent
+ * than the current execution priority and not masked; otherwise it
+ * stays pending until that changes.
+ *
+ * @param irq Interrupt number
+ */
+void raiseIrq(IrqNumber irq);
+
+/**
+ * @brief Check whether the caller runs in a simulated handler
+ * @return true inside an interrupt handler
+ */
+bool inInterrupt();
+
+/**
+ * @brief NVIC enable bit (system exceptions are always enabled)
+ * @param irq Interrupt number
+ * @param enable New state
+ */
+void setIrqEnabled(IrqNumber irq, bool enable);
+
+/**
+ * @brief Get NVIC enable bit
+ * @param irq Interrupt number
+ * @return true if enabled
+ */
+bool isIrqEnabled(IrqNumber irq);
+
+/**
+ * @brief Set pending state (setting it may run the handler)
+ * @param irq Interrupt number
+ * @param pending New state
+ */
+void setIrqPending(IrqNumber irq, bool pending);
+
+/**
+ * @brief Get pending state
+ * @param irq Interrupt number
+ * @return true if pending
+ */
+bool isIrqPending(IrqNumber irq);
+
+/**
+ * @brief Set priority register value
+ * @param irq Interrupt number
+ * @param value Register value (irqPriorityValue())
+ */
+void setIrqPriority(IrqNumber irq, u8 value);
+
+/**
+ * @brief Get priority register value
+ * @param irq Interrupt number
+ * @return Register value
+ */
+u8 getIrqPriority(IrqNumber irq);
+
+/*============================================================================
+ * Virtual Time
+ *===========================================================================*/
+/**
+ * @brief Advance time by whole ticks, running SysTick for each
+ * @param ms Milliseconds (ticks at 1 kHz)
+ */
+void advance(u32 ms);
+
+/**
+ * @brief Advance the cycle counter, running SysTick on tick boundaries
+ * @param cycles Core cycles
+ */
+void advanceCycles(u64 cycles);
+
+/**
+ * @brief Get the 64-bit cycle counter
+ * @return Cycles since reset()
+ */
+u64 getCycles();
+
+/**
+ * @brief Set the core clock (System::setClockProfile())
+ * 
+ * Cycles keep counting; ticks come every hz / TICK_RATE_HZ cycles from
+ * now on. reset() restores SYSTEM_CLOCK_HZ.
+ * 
+ * @param hz Core clock in Hz
+ */
+void setCoreClock(u32 hz);
+
+/**
+ * @brief Start or stop the simulated SysTick
+ * @param enable true to generate a tick every core clock / TICK_RATE_HZ cycles
+ */
+void enableSysTick(bool enable);
+
+/*============================================================================
+ * GPIO
+ *===========================================================================*/
+/**
+ * @brief GPIO port register block (RM0090 layout)
+ *
+ * BSRR writes are folded into ODR (and IDR for output pins) by
+ * syncGpio(), which the GPIO access paths call around every store.
+ */
+struct GpioRegisters {
+    volatile u32 moder;
+    volatile u32 otyper;
+    volatile u32 ospeedr;
+    volatile u32 pupdr;
+    volatile u32 idr;
+    volatile u32 odr;
+    volatile u32 bsrr;
+    volatile u32 lckr;
+    volatile u32 afr[2];
+};
+
+/**
+ * @brief Get the simulated port for a hardware base address
+ * @param base Port base address (PortId value)
+ * @return Register block, or nullptr for an unknown address
+ */
+GpioRegisters* gpioPort(u32 base);
+
+/**
+ * @brief Apply a pending BSRR write of a port
+ * @param reg Any register of the port's block
+ */
+void syncGpio(const volatile void* reg);
+
+/**
+ * @brief Drive an input pin from outside
+ *
+ * Runs the pin's interrupt callback if its trigger matches the edge.
+ *
+ * @param port Register block
+ * @param pin Pin number (0-15)
+ * @param high New level
+ */
+void setInput(GpioRegisters* port, u8 pin, bool high);
+
+/*============================================================================
+ * UART
+ *===========================================================================*/
+/**
+ * @brief Get bytes transmitted by a UART instance
+ * @param instance Instance pointer passed to the UART constructor
+ * @return Capture buffer (may be cleared by the caller)
+ */
+std::vector<u8>& uartOutput(void* instance);
+
+/**
+ * @brief Feed received bytes to a UART instance
+ *
+ * Bytes are delivered to the active receive callback (IT or DMA mode)
+ * in interrupt context, or buffered for the blocking receive().
+ *
+ * @param instance Instance pointer passed to the UART constructor
+ * @param data Received bytes
+ * @param length Number of bytes
+ */
+void uartInput(void* instance, const u8* data, size_t length);
+
+/*============================================================================
+ * ITM
+ *===========================================================================*/
+/**
+ * @brief Get bytes written to a stimulus port
+ * @param port Stimulus port (0-31)
+ * @return Capture buffer (may be cleared by the caller)
+ */
+std::vector<u8>& itmOutput(u8 port);
+
+/**
+ * @brief Make the ITM FIFO refuse writes, as when SWO falls behind
+ * @param busy true to reject every write
+ */
+void setItmBusy(bool busy);
+
+} // namespace sim
+} // namespace embedded
+
+#endif // SIM_SIM_HPP
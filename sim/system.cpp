@@ -0,0 +1,287 @@
+/**
+ * @file system.cpp
+ * @brief System implementation on the simulated core
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ *
+ * Host replacement for src/system.cpp: SysTick, DWT and NVIC accesses go
+ * to the sim/ models and delays advance virtual time instead of
+ * spinning.
+ */
+
+#include "system.hpp"
+#include "sim/sim.hpp"
+#include "profiler.hpp"
+#include "soft_timer.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace embedded {
+
+volatile u32 System::s_tickCount = 0;
+volatile u32 System::s_tickHigh = 0;
+u32 System::s_cycleHigh = 0;
+u32 System::s_cycleLast = 0;
+ClockProfile System::s_clockProfile = ClockProfile::Performance;
+u32 System::s_systemClock = SYSTEM_CLOCK_HZ;
+u32 System::s_apb1Clock = APB1_CLOCK_HZ;
+u32 System::s_apb2Clock = APB2_CLOCK_HZ;
+u32 System::s_cyclesPerUs = SYSTEM_CLOCK_HZ / 1000000;
+u64 System::s_microsBase = 0;
+u64 System::s_cyclesBase = 0;
+ClockListener* System::s_clockListeners = nullptr;
+
+namespace {
+
+// HCLK, PCLK1, PCLK2 indexed by ClockProfile (as src/system.cpp)
+const u32 CLOCK_PROFILES[][3] = {
+    { SYSTEM_CLOCK_HZ,     SYSTEM_CLOCK_HZ / 4, SYSTEM_CLOCK_HZ / 2 },
+    { SYSTEM_CLOCK_HZ / 2, SYSTEM_CLOCK_HZ / 4, SYSTEM_CLOCK_HZ / 2 },
+    { HSI_CLOCK_HZ,        HSI_CLOCK_HZ,        HSI_CLOCK_HZ }
+};
+
+} // namespace
+
+Status System::init() {
+    initClocks();
+    initDwt();
+    initSysTick();
+    initNvic();
+
+    return Status::Ok;
+}
+
+void System::startClocks() {
+    // The simulated core has no oscillators to start
+}
+
+void System::startPll() {
+}
+
+void System::reset() {
+    // A reset ends the simulation
+    std::fputs("System::reset()\n", stderr);
+    std::abort();
+}
+
+u32 System::getTicks() {
+    return s_tickCount;
+}
+
+u64 System::getTicks64() {
+    u32 high;
+    u32 low;
+    do {
+        high = s_tickHigh;
+        low = s_tickCount;
+    } while (high != s_tickHigh);
+
+    return (static_cast<u64>(high) << 32) | low;
+}
+
+void System::advanceTicks(u32 ticks) {
+    CriticalSection cs;
+    u32 old = s_tickCount;
+    s_tickCount = old + ticks;
+    if (s_tickCount < old) {
+        s_tickHigh = s_tickHigh + 1;
+    }
+}
+
+void System::delayMs(u32 ms) {
+    sim::advance(ms);
+}
+
+void System::delayUs(u32 us) {
+    sim::advanceCycles(static_cast<u64>(us) * s_cyclesPerUs);
+}
+
+u32 System::getCycles() {
+    return static_cast<u32>(sim::getCycles());
+}
+
+u64 System::getCycles64() {
+    CriticalSection cs;
+    u32 now = getCycles();
+    if (now < s_cycleLast) {
+        s_cycleHigh++;
+    }
+    s_cycleLast = now;
+    return (static_cast<u64>(s_cycleHigh) << 32) | now;
+}
+
+u64 System::getMicros() {
+    CriticalSection cs;
+    return s_microsBase + (getCycles64() - s_cyclesBase) / s_cyclesPerUs;
+}
+
+u32 System::getSystemClock() {
+    return s_systemClock;
+}
+
+u32 System::getApb1Clock() {
+    return s_apb1Clock;
+}
+
+u32 System::getApb2Clock() {
+    return s_apb2Clock;
+}
+
+Status System::setClockProfile(ClockProfile profile) {
+    if (static_cast<u8>(profile) > static_cast<u8>(ClockProfile::LowPower)) {
+        return Status::InvalidArg;
+    }
+    if (profile == s_clockProfile) {
+        return Status::Ok;
+    }
+
+    {
+        CriticalSection cs;
+        u64 cycles = getCycles64();
+        s_microsBase += (cycles - s_cyclesBase) / s_cyclesPerUs;
+        s_cyclesBase = cycles;
+
+        applyClockProfile(profile);
+    }
+
+    for (ClockListener* listener = s_clockListeners; listener != nullptr; ) {
+        ClockListener* next = listener->next;
+        listener->callback(listener->context);
+        listener = next;
+    }
+
+    return Status::Ok;
+}
+
+ClockProfile System::getClockProfile() {
+    return s_clockProfile;
+}
+
+void System::addClockListener(ClockListener* listener) {
+    CriticalSection cs;
+    for (ClockListener* entry = s_clockListeners; entry != nullptr; entry = entry->next) {
+        if (entry == listener) {
+            return;
+        }
+    }
+    listener->next = s_clockListeners;
+    s_clockListeners = listener;
+}
+
+void System::removeClockListener(ClockListener* listener) {
+    CriticalSection cs;
+    for (ClockListener** link = &s_clockListeners; *link != nullptr; link = &(*link)->next) {
+        if (*link == listener) {
+            *link = listener->next;
+            listener->next = nullptr;
+            return;
+        }
+    }
+}
+
+void System::sleep() {
+    // WFI: the next event is at the latest the next tick
+    sim::advance(1);
+}
+
+void System::deepSleep() {
+    sim::advance(1);
+}
+
+void System::idleUntil(u32 wakeTick) {
+    i32 remaining = static_cast<i32>(wakeTick - s_tickCount);
+    sim::advance(remaining > 0 ? static_cast<u32>(remaining) : 1);
+}
+
+void System::getUniqueId(u32* id) {
+    id[0] = 0x00200020;
+    id[1] = 0x484D5001;
+    id[2] = 0x20373233;
+}
+
+Status System::enablePeripheralClock(u32 peripheral) {
+    UNUSED(peripheral);
+    return Status::Ok;
+}
+
+Status System::disablePeripheralClock(u32 peripheral) {
+    UNUSED(peripheral);
+    return Status::Ok;
+}
+
+void System::initClocks() {
+    applyClockProfile(ClockProfile::Performance);
+}
+
+void System::applyClockProfile(ClockProfile profile) {
+    const u32* clocks = CLOCK_PROFILES[static_cast<u8>(profile)];
+    s_clockProfile = profile;
+    s_systemClock = clocks[0];
+    s_apb1Clock = clocks[1];
+    s_apb2Clock = clocks[2];
+    s_cyclesPerUs = clocks[0] / 1000000;
+    sim::setCoreClock(clocks[0]);
+}
+
+void System::initSysTick() {
+    s_tickCount = 0;
+    s_tickHigh = 0;
+    SoftTimer::init();
+    sim::setIrqHandler(IrqNumber::SysTick, SysTick_Handler);
+    sim::enableSysTick(true);
+}
+
+void System::initDwt() {
+    s_cycleHigh = 0;
+    s_cycleLast = getCycles();
+    s_microsBase = 0;
+    s_cyclesBase = getCycles();
+}
+
+void System::initNvic() {
+    setIrqPriority(IrqNumber::SysTick, IrqPriority::High);
+    setIrqPriority(IrqNumber::PendSV, IrqPriority::Lowest);
+}
+
+void System::enableIrq(IrqNumber irq) {
+    sim::setIrqEnabled(irq, true);
+}
+
+void System::disableIrq(IrqNumber irq) {
+    sim::setIrqEnabled(irq, false);
+}
+
+bool System::isIrqEnabled(IrqNumber irq) {
+    return sim::isIrqEnabled(irq);
+}
+
+void System::setIrqPriority(IrqNumber irq, IrqPriority priority) {
+    sim::setIrqPriority(irq, irqPriorityValue(priority));
+}
+
+u8 System::getIrqPriority(IrqNumber irq) {
+    return sim::getIrqPriority(irq);
+}
+
+void System::setIrqPending(IrqNumber irq) {
+    sim::setIrqPending(irq, true);
+}
+
+void System::clearIrqPending(IrqNumber irq) {
+    sim::setIrqPending(irq, false);
+}
+
+bool System::isIrqPending(IrqNumber irq) {
+    return sim::isIrqPending(irq);
+}
+
+} // namespace embedded
+
+extern "C" void SysTick_Handler(void) {
+    PROFILE_ISR(SysTick);
+    embedded::System::advanceTicks(1);
+    embedded::System::getCycles64();
+    embedded::SoftTimer::process(embedded::System::getTicks64());
+}
@@ -0,0 +1,292 @@
+/**
+ * @file uart.cpp
+ * @brief UART implementation on the simulated core
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ *
+ * Transmission completes immediately into sim::uartOutput(); the DMA
+ * path still goes through the TX ring, so ring-full back-pressure
+ * behaves as on the target. Received bytes come from sim::uartInput().
+ */
+
+#include "hal/uart.hpp"
+#include "sim/sim.hpp"
+#include "soft_timer.hpp"
+
+#include <deque>
+#include <map>
+
+namespace embedded {
+namespace sim {
+
+namespace {
+
+struct Port {
+    std::vector<u8> output;
+    std::deque<u8>  input;
+    hal::UART*      owner = nullptr;
+};
+
+std::map<void*, Port>& ports() {
+    static std::map<void*, Port> s_ports;
+    return s_ports;
+}
+
+} // namespace
+
+void resetUart() {
+    ports().clear();
+}
+
+std::vector<u8>& uartOutput(void* instance) {
+    return ports()[instance].output;
+}
+
+void uartInput(void* instance, const u8* data, size_t length) {
+    Port& port = ports()[instance];
+    port.input.insert(port.input.end(), data, data + length);
+    if (port.owner != nullptr) {
+        port.owner->handleRxEvent();
+    }
+}
+
+} // namespace sim
+
+namespace hal {
+
+namespace {
+
+sim::Port& simPort(void* instance) {
+    return sim::ports()[instance];
+}
+
+} // namespace
+
+UART::UART(void* instance)
+    : m_instance(instance)
+    , m_config()
+    , m_rxCallback(nullptr)
+    , m_txCallback(nullptr)
+    , m_rxContext(nullptr)
+    , m_txContext(nullptr)
+    , m_txDmaLength(0)
+    , m_txDma(nullptr)
+    , m_frameCallback(nullptr)
+    , m_frameContext(nullptr)
+    , m_rxDmaBuffer()
+    , m_rxReadPos(0)
+    , m_rxCrc(Crc::CRC32_INIT)
+    , m_rxDma(nullptr)
+    , m_clockListener()
+    , m_rxSignal() {
+}
+
+UART::~UART() {
+    deinit();
+}
+
+Status UART::init(const Config& config) {
+    if (config.baudRate == 0) {
+        return Status::InvalidArg;
+    }
+    m_config = config;
+    m_txRing.clear();
+    simPort(m_instance).owner = this;
+
+    m_clockListener.callback = onClockChange;
+    m_clockListener.context = this;
+    System::addClockListener(&m_clockListener);
+    return Status::Ok;
+}
+
+Status UART::deinit() {
+    sim::Port& port = simPort(m_instance);
+    if (port.owner == this) {
+        port.owner = nullptr;
+    }
+    m_rxCallback = nullptr;
+    m_frameCallback = nullptr;
+    System::removeClockListener(&m_clockListener);
+    return Status::Ok;
+}
+
+Status UART::transmit(u8 data) {
+    simPort(m_instance).output.push_back(data);
+    return Status::Ok;
+}
+
+Status UART::transmit(const u8* data, size_t length) {
+    if (data == nullptr) {
+        return Status::InvalidArg;
+    }
+    if (m_config.txDma) {
+        return transmitDMA(data, length);
+    }
+    std::vector<u8>& output = simPort(m_instance).output;
+    output.insert(output.end(), data, data + length);
+    return Status::Ok;
+}
+
+Status UART::print(const char* str) {
+    if (str == nullptr) {
+        return Status::InvalidArg;
+    }
+    size_t length = 0;
+    while (str[length] != '\0') {
+        length++;
+    }
+    return transmit(reinterpret_cast<const u8*>(str), length);
+}
+
+Status UART::receive(u8* data, u32 timeout) {
+    return receive(data, static_cast<size_t>(1), timeout);
+}
+
+Status UART::receive(u8* data, size_t length, u32 timeout) {
+    std::deque<u8>& input = simPort(m_instance).input;
+    Deadline deadline(timeout);
+    while (input.size() < length) {
+        // Sleeps in virtual time; SysTick work (SoftTimer) may feed input
+        if (!m_rxSignal.take(deadline.remaining())) {
+            return Status::Timeout;
+        }
+    }
+    for (size_t i = 0; i < length; i++) {
+        data[i] = input.front();
+        input.pop_front();
+    }
+    return Status::Ok;
+}
+
+Status UART::startReceiveIT(RxCallback callback, void* context) {
+    if (m_frameCallback != nullptr) {
+        return Status::Busy;
+    }
+    m_rxCallback = callback;
+    m_rxContext = context;
+    return Status::Ok;
+}
+
+Status UART::stopReceiveIT() {
+    m_rxCallback = nullptr;
+    return Status::Ok;
+}
+
+Status UART::startReceiveDMA(FrameCallback callback, void* context) {
+    if (m_rxCallback != nullptr) {
+        return Status::Busy;
+    }
+    m_frameCallback = callback;
+    m_frameContext = context;
+    m_rxReadPos = 0;
+    m_rxCrc = Crc::CRC32_INIT;
+    return Status::Ok;
+}
+
+Status UART::stopReceiveDMA() {
+    m_frameCallback = nullptr;
+    return Status::Ok;
+}
+
+void UART::handleRxEvent() {
+    std::deque<u8>& input = simPort(m_instance).input;
+
+    if (m_rxCallback != nullptr) {
+        while (!input.empty()) {
+            u8 byte = input.front();
+            input.pop_front();
+            m_rxCallback(byte, m_rxContext);
+        }
+    } else if (m_frameCallback != nullptr) {
+        // Same ring and wrap split as the circular DMA receiver
+        while (!input.empty()) {
+            size_t start = m_rxReadPos;
+            size_t length = 0;
+            while (!input.empty() && start + length < UART_RX_DMA_BUFFER_SIZE) {
+                m_rxDmaBuffer[start + length] = input.front();
+                input.pop_front();
+                length++;
+            }
+            m_rxReadPos = static_cast<u16>((start + length) % UART_RX_DMA_BUFFER_SIZE);
+            if (m_config.rxCrc) {
+                m_rxCrc = Crc::crc32(&m_rxDmaBuffer[start], length, m_rxCrc);
+            }
+            m_frameCallback(&m_rxDmaBuffer[start], length, m_frameContext);
+        }
+    } else if (!input.empty()) {
+        // Polled reception: wake a blocking receive()
+        m_rxSignal.give();
+    }
+}
+
+Status UART::transmitIT(const u8* data, size_t length, TxCallback callback, void* context) {
+    if (data == nullptr) {
+        return Status::InvalidArg;
+    }
+    std::vector<u8>& output = simPort(m_instance).output;
+    output.insert(output.end(), data, data + length);
+
+    m_txCallback = callback;
+    m_txContext = context;
+    if (m_txCallback != nullptr) {
+        m_txCallback(m_txContext);
+    }
+    return Status::Ok;
+}
+
+Status UART::transmitDMA(const u8* data, size_t length) {
+    if (data == nullptr) {
+        return Status::InvalidArg;
+    }
+    if (m_txRing.available() < length) {
+        return Status::NoMemory;
+    }
+    m_txRing.pushN(data, length);
+    startTxDma();
+    return Status::Ok;
+}
+
+size_t UART::getTxFree() const {
+    return m_txRing.available();
+}
+
+bool UART::isTxReady() const {
+    return m_txRing.empty();
+}
+
+void UART::flushTx() {
+    startTxDma();
+}
+
+void UART::flushRx() {
+    simPort(m_instance).input.clear();
+}
+
+Status UART::setBaudRate(u32 baudRate) {
+    if (baudRate == 0) {
+        return Status::InvalidArg;
+    }
+    m_config.baudRate = baudRate;
+    return Status::Ok;
+}
+
+void UART::onClockChange(void* context) {
+    // No BRR to recompute: the simulated line has no bit timing
+    UART* self = static_cast<UART*>(context);
+    self->setBaudRate(self->m_config.baudRate);
+}
+
+void UART::startTxDma() {
+    // The simulated stream drains the ring at once
+    std::vector<u8>& output = simPort(m_instance).output;
+    const u8* span;
+    size_t length;
+    while ((length = m_txRing.readSpan(span)) != 0) {
+        output.insert(output.end(), span, span + length);
+        m_txRing.consume(length);
+    }
+}
+
+} // namespace hal
+} // namespace embedded
@@ -0,0 +1,252 @@
+/**
+ * @file log.cpp
+ * @brief Deferred binary logging implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ * 
+ * Wire format (little endian), one frame per record:
+ * 
+ *   u8  sync       0xA5
+ *   u8  header     level << 4 | argc
+ *   u32 id         Offset of the format string in .log_strings
+ *   u32 timestamp  DWT cycle count
+ *   u32 args[argc]
+ * 
+ * id 0xFFFFFFFF reports dropped records, with the count in args[0].
+ * id 0xFFFFFFFE is a time sync: args[0] is the upper word of the 64-bit
+ * cycle count of the frame that follows. It is sent whenever that frame
+ * is half a CYCCNT wrap or more after the previous one, so the decoder
+ * never has to guess how often the 32-bit timestamp wrapped.
+ * 
+ * The same frames go to the debug UART or, with DEBUG_BACKEND_ITM, to
+ * stimulus port ITM_PORT_LOG.
+ */
+
+#include "log.hpp"
+#include "system.hpp"
+#include "hal/uart.hpp"
+#include "hal/itm.hpp"
+
+namespace embedded {
+
+static_assert((LOG_BUFFER_RECORDS & (LOG_BUFFER_RECORDS - 1)) == 0,
+              "LOG_BUFFER_RECORDS must be a power of two");
+static_assert(LOG_MAX_ARGS <= 15, "LOG_MAX_ARGS must fit the header nibble");
+
+namespace {
+
+constexpr u32 SLOT_MASK       = LOG_BUFFER_RECORDS - 1;
+constexpr u8  FRAME_SYNC      = 0xA5;
+constexpr u32 DROPPED_ID      = 0xFFFFFFFF;
+constexpr u32 SYNC_ID         = 0xFFFFFFFE;
+constexpr u64 SYNC_GAP        = 0x80000000;     ///< Half a CYCCNT wrap
+constexpr size_t FRAME_HEADER = 10;
+constexpr size_t FRAME_MAX    = FRAME_HEADER + 4 * LOG_MAX_ARGS;
+
+/**
+ * Record slot of a bounded multi-producer queue. For the slot at index
+ * k, sequence - (pos - k) tells whether position pos may be written (0),
+ * holds a committed record (1), or still holds the previous lap (< 0).
+ * All-zero is the valid empty state, so no runtime init is needed.
+ */
+struct Slot {
+    volatile u32    sequence;
+    u32             id;
+    u32             timestamp;
+    u8              level;
+    u8              argc;
+    u32             args[LOG_MAX_ARGS];
+};
+
+CCM_BSS Slot s_slots[LOG_BUFFER_RECORDS];
+u32         s_enqueuePos;           ///< Next position to reserve (producers)
+u32         s_dequeuePos;           ///< Next position to send (consumer)
+u32         s_dropped;
+u32         s_droppedReported;
+u64         s_lastCycles;           ///< Wrap-extended timestamp of the last frame
+hal::UART*  s_uart;
+
+#if DEBUG_BACKEND == DEBUG_BACKEND_ITM
+// Frame the ITM FIFO has not taken completely yet
+u8          s_pending[FRAME_MAX];
+size_t      s_pendingLength;
+size_t      s_pendingSent;
+#endif
+
+inline u32 lapBase(u32 pos) {
+    return pos & ~SLOT_MASK;
+}
+
+void putWord(u8* dst, u32 value) {
+    dst[0] = static_cast<u8>(value);
+    dst[1] = static_cast<u8>(value >> 8);
+    dst[2] = static_cast<u8>(value >> 16);
+    dst[3] = static_cast<u8>(value >> 24);
+}
+
+size_t encode(u8* frame, u8 level, u32 id, u32 timestamp, const u32* args, u8 argc) {
+    // Writers never exceed it; the bound keeps frame[] provably in range
+    if (argc > LOG_MAX_ARGS) {
+        argc = LOG_MAX_ARGS;
+    }
+
+    frame[0] = FRAME_SYNC;
+    frame[1] = static_cast<u8>((level << 4) | argc);
+    putWord(&frame[2], id);
+    putWord(&frame[6], timestamp);
+    for (u8 i = 0; i < argc; i++) {
+        putWord(&frame[FRAME_HEADER + 4 * i], args[i]);
+    }
+    return FRAME_HEADER + 4 * argc;
+}
+
+/*============================================================================
+ * Output Backend
+ *===========================================================================*/
+#if DEBUG_BACKEND == DEBUG_BACKEND_ITM
+
+bool flushPending() {
+    s_pendingSent += hal::Itm::write(ITM_PORT_LOG, &s_pending[s_pendingSent],
+                                     s_pendingLength - s_pendingSent);
+    return s_pendingSent == s_pendingLength;
+}
+
+bool outputAttached() {
+    return hal::Itm::isEnabled(ITM_PORT_LOG);
+}
+
+// A frame is only started once the previous one is out
+bool outputReady(size_t length) {
+    UNUSED(length);
+    return flushPending();
+}
+
+void output(const u8* frame, size_t length) {
+    std::memcpy(s_pending, frame, length);
+    s_pendingLength = length;
+    s_pendingSent = 0;
+    flushPending();
+}
+
+#else
+
+bool outputAttached() {
+    return s_uart != nullptr;
+}
+
+bool outputReady(size_t length) {
+    return s_uart->getTxFree() >= length;
+}
+
+void output(const u8* frame, size_t length) {
+    s_uart->transmitDMA(frame, length);
+}
+
+#endif
+
+// Records are sent well within one wrap of being logged
+u64 extendCycles(u32 timestamp) {
+    u64 now = System::getCycles64();
+    return now - static_cast<u32>(static_cast<u32>(now) - timestamp);
+}
+
+// Send one frame, preceded by a time sync after a long gap
+bool send(u8 level, u32 id, u64 cycles, const u32* args, u8 argc) {
+    u8 frame[FRAME_MAX];
+    u32 timestamp = static_cast<u32>(cycles);
+
+    if (cycles - s_lastCycles >= SYNC_GAP) {
+        if (!outputReady(FRAME_HEADER + 4)) {
+            return false;
+        }
+        u32 high = static_cast<u32>(cycles >> 32);
+        output(frame, encode(frame, static_cast<u8>(Log::Level::Debug), SYNC_ID,
+                             timestamp, &high, 1));
+        s_lastCycles = cycles;
+    }
+
+    if (!outputReady(FRAME_HEADER + 4u * argc)) {
+        return false;
+    }
+    output(frame, encode(frame, level, id, timestamp, args, argc));
+    s_lastCycles = cycles;
+    return true;
+}
+
+} // namespace
+
+void Log::init(hal::UART* uart) {
+    s_uart = uart;
+}
+
+void Log::record(Level level, const char* id, const u32* args, u8 argc) {
+    u32 timestamp = System::getCycles();
+
+    // Reserve a slot; a preempting logger simply takes the next one
+    u32 pos = __atomic_load_n(&s_enqueuePos, __ATOMIC_RELAXED);
+    Slot* slot;
+    while (true) {
+        slot = &s_slots[pos & SLOT_MASK];
+        i32 diff = static_cast<i32>(slot->sequence - lapBase(pos));
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&s_enqueuePos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            __atomic_fetch_add(&s_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        } else {
+            pos = __atomic_load_n(&s_enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->id = static_cast<u32>(reinterpret_cast<uintptr_t>(id));
+    slot->timestamp = timestamp;
+    slot->level = static_cast<u8>(level);
+    slot->argc = argc;
+    for (u8 i = 0; i < argc; i++) {
+        slot->args[i] = args[i];
+    }
+
+    DMB();
+    slot->sequence = lapBase(pos) + 1;
+}
+
+void Log::process() {
+    if (!outputAttached()) {
+        return;
+    }
+
+    u32 dropped = __atomic_load_n(&s_dropped, __ATOMIC_RELAXED);
+    if (dropped != s_droppedReported) {
+        u32 count = dropped - s_droppedReported;
+        if (send(static_cast<u8>(Level::Warning), DROPPED_ID, System::getCycles64(), &count, 1)) {
+            s_droppedReported = dropped;
+        }
+    }
+
+    while (true) {
+        Slot* slot = &s_slots[s_dequeuePos & SLOT_MASK];
+        if (slot->sequence != lapBase(s_dequeuePos) + 1) {
+            // Empty, or the oldest reservation is not committed yet
+            return;
+        }
+        DMB();
+
+        if (!send(slot->level, slot->id, extendCycles(slot->timestamp), slot->args, slot->argc)) {
+            return;
+        }
+
+        DMB();
+        slot->sequence = lapBase(s_dequeuePos) + LOG_BUFFER_RECORDS;
+        s_dequeuePos++;
+    }
+}
+
+u32 Log::getDropped() {
+    return __atomic_load_n(&s_dropped, __ATOMIC_RELAXED);
+}
+
+} // namespace embedded
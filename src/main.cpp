@@ -7,18 +7,112 @@
  */
 
 #include "system.hpp"
+#include "scheduler.hpp"
+#include "log.hpp"
+#include "profiler.hpp"
 #include "hal/gpio.hpp"
+#include "hal/gpio_pin.hpp"
 #include "hal/uart.hpp"
+#include "hal/itm.hpp"
+#include "hal/crc.hpp"
+#include "rtos.hpp"
 
 using namespace embedded;
 using namespace embedded::hal;
 
 // Hardware definitions (adjust for your board)
-#define LED_PORT            GPIOA
+#define LED_PORT            PortId::A
 #define LED_PIN             5
 
 #define DEBUG_UART          USART2
 
+using LedPin = GpioPin<LED_PORT, LED_PIN>;
+
+#define BLINK_PERIOD_MS     500
+#define HEARTBEAT_PERIOD_MS 1000
+#define LOG_PERIOD_MS       10
+
+/*============================================================================
+ * Application Tasks
+ *===========================================================================*/
+static Scheduler::Task blinkTask;
+static Scheduler::Task heartbeatTask;
+static Scheduler::Task logTask;
+static Scheduler::Task debugInitTask;
+
+/**
+ * @brief Boot record kept across warm resets
+ */
+struct BootRecord {
+    u32 magic;
+    u32 warmResets;
+};
+
+static constexpr u32 BOOT_MAGIC = 0xB007B007;
+NOINIT static BootRecord bootRecord;
+
+/**
+ * @brief Toggle the status LED
+ * @param context Unused
+ */
+static void onBlink(void* context) {
+    UNUSED(context);
+    LedPin::toggle();
+}
+
+/**
+ * @brief Log uptime heartbeat and CPU headroom
+ * @param context Unused
+ */
+static void onHeartbeat(void* context) {
+    UNUSED(context);
+    LOG_INFO("Heartbeat: %us, idle %u%%",
+             static_cast<u32>(System::getTicks64() / 1000), Profiler::getIdlePercent());
+}
+
+/**
+ * @brief Stream queued log records to the debug UART
+ * @param context Unused
+ */
+static void onLog(void* context) {
+    UNUSED(context);
+    Log::process();
+}
+
+/**
+ * @brief Bring up the debug UART and the log output
+ * 
+ * Records logged before this point are kept and sent once it ran.
+ * 
+ * @param context Debug UART
+ */
+static void onDebugInit(void* context) {
+    UART* debug = static_cast<UART*>(context);
+
+    UART::Config uartConfig;
+    uartConfig.baudRate = 115200;
+    uartConfig.dataBits = UART::DataBits::Eight;
+    uartConfig.parity = UART::Parity::None;
+    uartConfig.stopBits = UART::StopBits::One;
+    uartConfig.txDma = true;
+    
+    if (debug->init(uartConfig) != Status::Ok) {
+        // UART initialization failed
+        while (true) {
+            LedPin::toggle();
+            System::delayMs(100);
+        }
+    }
+
+#if DEBUG_BACKEND == DEBUG_BACKEND_ITM
+    // Log frames and profiler events go out on SWO instead
+    Itm::init();
+#endif
+
+    // Decode with tools/log_decode.py
+    Log::init(debug);
+}
+
 /**
  * @brief Application entry point
  */
@@ -32,74 +126,63 @@ int main() {
     }
 
     // Configure LED GPIO
-    GPIO led(LED_PORT, LED_PIN);
+    GPIO led = LedPin::toGpio();
     led.setMode(GPIO::Mode::Output);
     led.setSpeed(GPIO::Speed::Low);
     led.setPull(GPIO::Pull::None);
 
-    // Configure debug UART
-    UART debug(DEBUG_UART);
-    UART::Config uartConfig;
-    uartConfig.baudRate = 115200;
-    uartConfig.dataBits = UART::DataBits::Eight;
-    uartConfig.parity = UART::Parity::None;
-    uartConfig.stopBits = UART::StopBits::One;
-    
-    if (debug.init(uartConfig) != Status::Ok) {
-        // UART initialization failed
-        while (true) {
-            led.toggle();
-            System::delayMs(100);
-        }
-    }
+    // Frame and record checks use the CRC unit from here on
+    Crc::init();
 
-    // Print startup message
-    debug.print("\r\n");
-    debug.print("================================\r\n");
-    debug.print("  Embedded Firmware Framework\r\n");
-    debug.print("  Version 1.0.0 (2016)\r\n");
-    debug.print("================================\r\n");
-    debug.print("\r\n");
-    debug.print("System initialized successfully.\r\n");
-
-    // Main application loop
-    u32 counter = 0;
-    while (true) {
-        // Toggle LED
-        led.toggle();
-        
-        // Print heartbeat message every second
-        counter++;
-        if (counter % 2 == 0) {
-            debug.print("Heartbeat: ");
-            // Simple integer to string conversion
-            char buf[16];
-            u32 ticks = System::getTicks() / 1000;
-            int idx = 0;
-            if (ticks == 0) {
-                buf[idx++] = '0';
-            } else {
-                char temp[16];
-                int tempIdx = 0;
-                while (ticks > 0) {
-                    temp[tempIdx++] = '0' + (ticks % 10);
-                    ticks /= 10;
-                }
-                while (tempIdx > 0) {
-                    buf[idx++] = temp[--tempIdx];
-                }
-            }
-            buf[idx++] = 's';
-            buf[idx++] = '\r';
-            buf[idx++] = '\n';
-            buf[idx] = '\0';
-            debug.print(buf);
-        }
-        
-        // Delay 500ms
-        System::delayMs(500);
+    // Count warm resets; the record is garbage after power-on
+    if (bootRecord.magic != BOOT_MAGIC) {
+        bootRecord.magic = BOOT_MAGIC;
+        bootRecord.warmResets = 0;
+    } else {
+        bootRecord.warmResets++;
     }
 
+    LOG_INFO("Embedded Firmware Framework v1.0.0 (2016)");
+    LOG_INFO("Warm resets: %u", bootRecord.warmResets);
+
+    Scheduler::init();
+
+    // Debug output: now, or once the application tasks had their first run
+    UART debug(DEBUG_UART);
+#if BOOT_LAZY_INIT
+    debugInitTask.handler = onDebugInit;
+    debugInitTask.context = &debug;
+    Scheduler::startOnce(&debugInitTask, 1);
+#else
+    onDebugInit(&debug);
+#endif
+
+    // Hand control to the scheduler; the core sleeps between tasks
+    blinkTask.handler = onBlink;
+    blinkTask.context = nullptr;
+    Scheduler::startPeriodic(&blinkTask, BLINK_PERIOD_MS);
+
+    heartbeatTask.handler = onHeartbeat;
+    heartbeatTask.context = nullptr;
+    Scheduler::startPeriodic(&heartbeatTask, HEARTBEAT_PERIOD_MS, HEARTBEAT_PERIOD_MS);
+
+    logTask.handler = onLog;
+    logTask.context = nullptr;
+    Scheduler::startPeriodic(&logTask, LOG_PERIOD_MS);
+
+    // Separate profiler entries for the tasks worth watching
+    Profiler::attach(&heartbeatTask, "heartbeat");
+    Profiler::attach(&logTask, "log");
+
+    LOG_INFO("System initialized successfully.");
+
+#if USE_RTOS
+    // The scheduler becomes one task; protocol stacks may add their own
+    Rtos::start();
+#else
+    Scheduler::run();
+#endif
+
     return 0;
 }
 
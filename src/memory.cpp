@@ -0,0 +1,229 @@
+/**
+ * @file memory.cpp
+ * @brief Pool and arena allocator implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "memory.hpp"
+
+#include <new>
+#include <cerrno>
+
+namespace embedded {
+
+static_assert(MEMORY_POOL_SMALL_SIZE % 8 == 0 &&
+              MEMORY_POOL_MEDIUM_SIZE % 8 == 0 &&
+              MEMORY_POOL_LARGE_SIZE % 8 == 0,
+              "Pool block sizes must be multiples of 8");
+static_assert(MEMORY_POOL_SMALL_SIZE < MEMORY_POOL_MEDIUM_SIZE &&
+              MEMORY_POOL_MEDIUM_SIZE < MEMORY_POOL_LARGE_SIZE,
+              "Pool block sizes must be ascending");
+
+/*============================================================================
+ * Pool
+ *===========================================================================*/
+void* Pool::allocate() {
+    CriticalSection cs;
+
+    void* block;
+    if (m_freeList != nullptr) {
+        block = m_freeList;
+        m_freeList = m_freeList->next;
+    } else if (m_carved < m_blockCount) {
+        block = m_storage + m_carved * m_blockSize;
+        m_carved++;
+    } else {
+        m_failures++;
+        return nullptr;
+    }
+
+    m_used++;
+    if (m_used > m_highWater) {
+        m_highWater = m_used;
+    }
+    return block;
+}
+
+Status Pool::free(void* block) {
+    if (!owns(block)) {
+        return Status::InvalidArg;
+    }
+
+    size_t offset = static_cast<size_t>(static_cast<u8*>(block) - m_storage);
+    if (offset % m_blockSize != 0) {
+        return Status::InvalidArg;
+    }
+
+    CriticalSection cs;
+
+    // Never carved, or more frees than allocations
+    if (offset >= m_carved * m_blockSize || m_used == 0) {
+        return Status::InvalidArg;
+    }
+
+    FreeBlock* node = static_cast<FreeBlock*>(block);
+#if DEBUG_ENABLED
+    // Double free: the block is already on the free list
+    for (FreeBlock* entry = m_freeList; entry != nullptr; entry = entry->next) {
+        if (entry == node) {
+            return Status::InvalidArg;
+        }
+    }
+#endif
+    node->next = m_freeList;
+    m_freeList = node;
+    m_used--;
+    return Status::Ok;
+}
+
+MemoryStats Pool::getStats() const {
+    CriticalSection cs;
+    return MemoryStats{ m_used, m_highWater, m_failures };
+}
+
+/*============================================================================
+ * Arena
+ *===========================================================================*/
+void* Arena::allocate(size_t size, size_t alignment) {
+    CriticalSection cs;
+
+    uintptr_t base = reinterpret_cast<uintptr_t>(m_storage);
+    uintptr_t start = (base + m_offset + alignment - 1) & ~(alignment - 1);
+    size_t end = start - base + size;
+
+    if (end > m_size) {
+        m_failures++;
+        return nullptr;
+    }
+
+    m_offset = end;
+    if (m_offset > m_highWater) {
+        m_highWater = m_offset;
+    }
+    return reinterpret_cast<void*>(start);
+}
+
+void Arena::reset() {
+    CriticalSection cs;
+    m_offset = 0;
+}
+
+MemoryStats Arena::getStats() const {
+    CriticalSection cs;
+    return MemoryStats{ m_offset, m_highWater, m_failures };
+}
+
+/*============================================================================
+ * System Allocator
+ *===========================================================================*/
+namespace {
+
+POOL_STORAGE u8 s_smallStorage[MEMORY_POOL_SMALL_SIZE * MEMORY_POOL_SMALL_COUNT];
+POOL_STORAGE u8 s_mediumStorage[MEMORY_POOL_MEDIUM_SIZE * MEMORY_POOL_MEDIUM_COUNT];
+POOL_STORAGE u8 s_largeStorage[MEMORY_POOL_LARGE_SIZE * MEMORY_POOL_LARGE_COUNT];
+POOL_STORAGE u8 s_arenaStorage[MEMORY_ARENA_SIZE];
+
+// Constant-initialized, so usable from static constructors
+Pool s_pools[] = {
+    { s_smallStorage,  MEMORY_POOL_SMALL_SIZE,  MEMORY_POOL_SMALL_COUNT },
+    { s_mediumStorage, MEMORY_POOL_MEDIUM_SIZE, MEMORY_POOL_MEDIUM_COUNT },
+    { s_largeStorage,  MEMORY_POOL_LARGE_SIZE,  MEMORY_POOL_LARGE_COUNT },
+};
+
+Arena s_arena(s_arenaStorage, sizeof(s_arenaStorage));
+
+} // namespace
+
+void* Memory::allocate(size_t size) {
+    for (Pool& pool : s_pools) {
+        if (size <= pool.getBlockSize()) {
+            void* block = pool.allocate();
+            if (block != nullptr) {
+                return block;
+            }
+            // Pool exhausted: fall back to the next larger block size
+        }
+    }
+    return nullptr;
+}
+
+void Memory::free(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    for (Pool& pool : s_pools) {
+        if (pool.owns(ptr)) {
+            pool.free(ptr);
+            return;
+        }
+    }
+}
+
+Pool& Memory::getPool(PoolId id) {
+    return s_pools[static_cast<size_t>(id)];
+}
+
+Arena& Memory::getArena() {
+    return s_arena;
+}
+
+} // namespace embedded
+
+/*============================================================================
+ * Global Allocation Operators
+ *===========================================================================*/
+// The host build keeps the C++ runtime heap (test frameworks, sanitizers)
+#if !EMBEDDED_HOST_BUILD
+
+void* operator new(size_t size) {
+    void* ptr = embedded::Memory::allocate(size);
+    if (ptr == nullptr) {
+        while (true) {
+            // Trap: out of pool memory (see Memory::getPool() stats)
+        }
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return embedded::Memory::allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return embedded::Memory::allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    embedded::Memory::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    embedded::Memory::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    embedded::Memory::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    embedded::Memory::free(ptr);
+}
+
+/**
+ * @brief Disable the newlib heap
+ *
+ * malloc() fails immediately instead of growing into the stack.
+ */
+extern "C" void* _sbrk(ptrdiff_t increment) {
+    UNUSED(increment);
+    errno = ENOMEM;
+    return reinterpret_cast<void*>(-1);
+}
+
+#endif // !EMBEDDED_HOST_BUILD
@@ -0,0 +1,224 @@
+/**
+ * @file profiler.cpp
+ * @brief Runtime cycle accounting implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "profiler.hpp"
+#include "system.hpp"
+#include "hal/uart.hpp"
+#include "hal/itm.hpp"
+
+namespace embedded {
+
+constexpr size_t Profiler::SLOTS;
+
+namespace {
+
+constexpr u8  FIXED_SLOTS     = static_cast<u8>(Profiler::Slot::Count);
+constexpr u32 EVENT_CYCLES_MAX = 0x00FFFFFF;
+
+const char* const FIXED_NAMES[FIXED_SLOTS] = {
+    "tasks", "systick", "exti", "uart", "spi", "i2c", "dma"
+};
+
+/**
+ * One running handler. Time spent in handlers that preempted it is
+ * collected in nested and taken out of its own total on exit.
+ */
+struct Frame {
+    u32 start;
+    u32 nested;
+};
+
+struct Counters {
+    u32 calls;
+    u64 cycles;
+    u32 maxCycles;
+    u32 maxLatency;
+};
+
+CCM_BSS Counters    s_counters[Profiler::SLOTS];
+CCM_BSS Frame       s_frames[PROFILER_MAX_NESTING];
+u32                 s_depth;
+const char*         s_taskNames[PROFILER_TASK_SLOTS];
+u8                  s_taskSlots;
+
+// Idle window: busy cycles are measured, wall time comes from SysTick
+u64                 s_windowTick;
+u64                 s_windowCycles;
+u64                 s_idleCycles;
+u64                 s_idleStart;
+ClockListener       s_clockListener;
+
+void restartWindow() {
+    s_windowTick = System::getTicks64();
+    s_windowCycles = System::getCycles64();
+    s_idleCycles = 0;
+}
+
+void onClockChange(void* context) {
+    UNUSED(context);
+    CriticalSection cs;
+    restartWindow();
+}
+
+void printNumber(hal::UART* uart, u64 value) {
+    char digits[21];
+    size_t pos = sizeof(digits);
+    do {
+        digits[--pos] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    uart->transmit(reinterpret_cast<const u8*>(&digits[pos]), sizeof(digits) - pos);
+}
+
+} // namespace
+
+Status Profiler::attach(Scheduler::Task* task, const char* name) {
+    if (task == nullptr || name == nullptr) {
+        return Status::InvalidArg;
+    }
+
+    CriticalSection cs;
+    if (s_taskSlots >= PROFILER_TASK_SLOTS) {
+        return Status::NoMemory;
+    }
+    s_taskNames[s_taskSlots] = name;
+    task->profile = static_cast<u8>(FIXED_SLOTS + s_taskSlots);
+    s_taskSlots++;
+
+    return Status::Ok;
+}
+
+void Profiler::reset() {
+    CriticalSection cs;
+    for (size_t i = 0; i < SLOTS; i++) {
+        s_counters[i] = Counters();
+    }
+    restartWindow();
+
+    s_clockListener.callback = onClockChange;
+    System::addClockListener(&s_clockListener);
+}
+
+bool Profiler::read(size_t index, Entry& entry) {
+    if (index >= static_cast<size_t>(FIXED_SLOTS + s_taskSlots)) {
+        return false;
+    }
+
+    CriticalSection cs;
+    const Counters& counters = s_counters[index];
+    entry.name = (index < FIXED_SLOTS) ? FIXED_NAMES[index] : s_taskNames[index - FIXED_SLOTS];
+    entry.calls = counters.calls;
+    entry.cycles = counters.cycles;
+    entry.maxCycles = counters.maxCycles;
+    entry.maxLatency = counters.maxLatency;
+
+    return true;
+}
+
+u8 Profiler::getIdlePercent() {
+    u64 wall;
+    u64 busy;
+    {
+        CriticalSection cs;
+        const u32 cyclesPerTick = System::getSystemClock() / TICK_RATE_HZ;
+        wall = (System::getTicks64() - s_windowTick) * cyclesPerTick;
+        busy = System::getCycles64() - s_windowCycles - s_idleCycles;
+    }
+
+    if (wall == 0 || busy >= wall) {
+        return 0;
+    }
+    return static_cast<u8>(((wall - busy) * 100) / wall);
+}
+
+void Profiler::print(hal::UART* uart) {
+    if (uart == nullptr) {
+        return;
+    }
+
+    Entry entry;
+    for (size_t i = 0; read(i, entry); i++) {
+        if (entry.calls == 0) {
+            continue;
+        }
+        uart->print("PROF,");
+        uart->print(entry.name);
+        uart->print(",");
+        printNumber(uart, entry.calls);
+        uart->print(",");
+        printNumber(uart, entry.cycles);
+        uart->print(",");
+        printNumber(uart, entry.maxCycles);
+        uart->print(",");
+        printNumber(uart, entry.maxLatency);
+        uart->print("\r\n");
+    }
+
+    uart->print("PROF_IDLE,");
+    printNumber(uart, getIdlePercent());
+    uart->print("\r\n");
+}
+
+void Profiler::idleBegin() {
+    s_idleStart = System::getCycles64();
+}
+
+void Profiler::idleEnd() {
+    // Called with interrupts masked: the waking handler runs afterwards
+    s_idleCycles += System::getCycles64() - s_idleStart;
+}
+
+RAM_FUNC void Profiler::enter(u8 slot, u32 latency) {
+    u32 primask = disableInterrupts();
+
+    if (s_depth < PROFILER_MAX_NESTING) {
+        s_frames[s_depth].start = System::getCycles();
+        s_frames[s_depth].nested = 0;
+    }
+    s_depth++;
+
+    Counters& counters = s_counters[slot];
+    if (latency > counters.maxLatency) {
+        counters.maxLatency = latency;
+    }
+
+    restoreInterrupts(primask);
+}
+
+RAM_FUNC void Profiler::exit(u8 slot) {
+    u32 primask = disableInterrupts();
+    u32 own = 0;
+
+    s_depth--;
+    if (s_depth < PROFILER_MAX_NESTING) {
+        const Frame& frame = s_frames[s_depth];
+        u32 elapsed = System::getCycles() - frame.start;
+        own = elapsed - frame.nested;
+
+        Counters& counters = s_counters[slot];
+        counters.calls++;
+        counters.cycles += own;
+        if (own > counters.maxCycles) {
+            counters.maxCycles = own;
+        }
+
+        if (s_depth > 0) {
+            s_frames[s_depth - 1].nested += elapsed;
+        }
+    }
+
+    restoreInterrupts(primask);
+
+#if DEBUG_BACKEND == DEBUG_BACKEND_ITM
+    // Event: slot in the top byte, own cycles below (dropped if the FIFO is busy)
+    hal::Itm::writeWord(ITM_PORT_PROFILE, (static_cast<u32>(slot) << 24) |
+                                          (own < EVENT_CYCLES_MAX ? own : EVENT_CYCLES_MAX));
+#endif
+}
+
+} // namespace embedded
@@ -0,0 +1,276 @@
+/**
+ * @file rtos.cpp
+ * @brief RTOS integration (USE_RTOS) and blocking primitives implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "rtos.hpp"
+#include "soft_timer.hpp"
+#include "profiler.hpp"
+
+#if USE_RTOS
+#include "scheduler.hpp"
+
+extern "C" void xPortSysTickHandler(void);
+#endif
+
+namespace embedded {
+
+#if USE_RTOS
+
+static_assert(configMAX_SYSCALL_INTERRUPT_PRIORITY == irqPriorityValue(IrqPriority::High),
+              "FreeRTOSConfig.h syscall priority out of sync with IrqPriority");
+static_assert(RTOS_SCHEDULER_PRIORITY < RTOS_MAX_PRIORITIES, "RTOS_SCHEDULER_PRIORITY out of range");
+
+/*============================================================================
+ * Kernel Glue
+ *===========================================================================*/
+namespace {
+
+StaticTask_t s_schedulerTask;
+StackType_t  s_schedulerStack[RTOS_SCHEDULER_STACK];
+
+StaticTask_t s_idleTask;
+StackType_t  s_idleStack[configMINIMAL_STACK_SIZE];
+
+void schedulerTask(void* parameters) {
+    UNUSED(parameters);
+    Scheduler::run();
+}
+
+} // namespace
+
+void Rtos::start() {
+    xTaskCreateStatic(schedulerTask, "scheduler", RTOS_SCHEDULER_STACK, nullptr,
+                      RTOS_SCHEDULER_PRIORITY, s_schedulerStack, &s_schedulerTask);
+    vTaskStartScheduler();
+
+    // Only reached if the idle task could not be created
+    while (true) {
+    }
+}
+
+void Rtos::tick() {
+    if (isRunning()) {
+        xPortSysTickHandler();
+    }
+}
+
+/*============================================================================
+ * Semaphore (FreeRTOS)
+ *===========================================================================*/
+// Any kernel call before vTaskStartScheduler() leaves BASEPRI raised until
+// the kernel starts, which would stop SysTick during boot. The kernel
+// object is therefore created by the first take() in a task; until then
+// a give() is kept in m_given.
+Semaphore::Semaphore()
+    : m_storage()
+    , m_handle(nullptr)
+    , m_given(false) {
+}
+
+Semaphore::~Semaphore() {
+    if (m_handle != nullptr) {
+        vSemaphoreDelete(m_handle);
+    }
+}
+
+bool Semaphore::take(u32 timeoutMs) {
+    if (Rtos::inInterrupt()) {
+        if (m_handle == nullptr) {
+            bool given = m_given;
+            m_given = false;
+            return given;
+        }
+        return xSemaphoreTakeFromISR(m_handle, nullptr) == pdTRUE;
+    }
+
+    if (Rtos::isRunning()) {
+        if (m_handle == nullptr) {
+            taskENTER_CRITICAL();
+            m_handle = xSemaphoreCreateBinaryStatic(&m_storage);
+            if (m_given) {
+                m_given = false;
+                xSemaphoreGive(m_handle);
+            }
+            taskEXIT_CRITICAL();
+        }
+        TickType_t ticks = (timeoutMs == WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+        return xSemaphoreTake(m_handle, ticks) == pdTRUE;
+    }
+
+    // No task to block yet: sleep between interrupts as bare-metal does
+    Deadline deadline(timeoutMs);
+    while (true) {
+        u32 primask = disableInterrupts();
+        if (m_given) {
+            m_given = false;
+            restoreInterrupts(primask);
+            return true;
+        }
+        if (deadline.expired()) {
+            restoreInterrupts(primask);
+            return false;
+        }
+        System::sleep();
+        restoreInterrupts(primask);
+    }
+}
+
+void Semaphore::give() {
+    if (Rtos::inInterrupt()) {
+        // Tasks create the handle inside a critical section, so an
+        // interrupt sees it either missing or complete
+        if (m_handle == nullptr) {
+            m_given = true;
+            return;
+        }
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(m_handle, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else if (Rtos::isRunning()) {
+        taskENTER_CRITICAL();
+        if (m_handle == nullptr) {
+            m_given = true;
+        } else {
+            xSemaphoreGive(m_handle);
+        }
+        taskEXIT_CRITICAL();
+    } else {
+        m_given = true;
+    }
+}
+
+#else
+
+/*============================================================================
+ * Semaphore (bare-metal)
+ *===========================================================================*/
+Semaphore::Semaphore()
+    : m_given(false) {
+}
+
+Semaphore::~Semaphore() {
+}
+
+bool Semaphore::take(u32 timeoutMs) {
+    Deadline deadline(timeoutMs);
+    while (true) {
+        // Check and sleep with interrupts masked: a give() landing in
+        // between leaves its interrupt pending, which ends the WFI
+        u32 primask = disableInterrupts();
+        if (m_given) {
+            m_given = false;
+            restoreInterrupts(primask);
+            return true;
+        }
+        if (deadline.expired()) {
+            restoreInterrupts(primask);
+            return false;
+        }
+        System::sleep();
+        restoreInterrupts(primask);
+    }
+}
+
+void Semaphore::give() {
+    m_given = true;
+}
+
+#endif // USE_RTOS
+
+} // namespace embedded
+
+#if USE_RTOS
+
+/*============================================================================
+ * FreeRTOS Hooks
+ *===========================================================================*/
+extern "C" void vApplicationGetIdleTaskMemory(StaticTask_t** taskBuffer, StackType_t** stack,
+                                              configSTACK_DEPTH_TYPE* stackSize) {
+    *taskBuffer = &embedded::s_idleTask;
+    *stack = embedded::s_idleStack;
+    *stackSize = configMINIMAL_STACK_SIZE;
+}
+
+/**
+ * @brief Keep the port's hands off SysTick
+ *
+ * The default programs SysTick from configCPU_CLOCK_HZ, which is wrong
+ * after a clock profile change; System::init() has already set it up.
+ */
+extern "C" void vPortSetupTimerInterrupt(void) {
+}
+
+/**
+ * @brief Idle task hook: sleep until the next interrupt
+ *
+ * Bracketed like the bare-metal scheduler's idle sleep so that
+ * Profiler::getIdlePercent() counts it. With tickless idle the kernel
+ * then suppresses the tick from the idle task once it runs again.
+ */
+extern "C" void vApplicationIdleHook(void) {
+    using namespace embedded;
+
+    u32 primask = disableInterrupts();
+    PROFILE_IDLE_BEGIN();
+    System::sleep();
+    PROFILE_IDLE_END();
+    restoreInterrupts(primask);
+}
+
+extern "C" void vApplicationStackOverflowHook(TaskHandle_t task, char* name) {
+    UNUSED(task);
+    UNUSED(name);
+    embedded::disableInterrupts();
+    while (true) {
+        // Trap in stack overflow
+    }
+}
+
+#if configUSE_TICKLESS_IDLE == 2
+/**
+ * @brief Tickless idle, called by the idle task with the kernel suspended
+ *
+ * System::idleUntil() stops SysTick, sleeps and compensates the System
+ * tick count for the periods it skipped; the kernel tick is stepped by
+ * the same amount. The final tick, if the sleep ran to the end, arrives
+ * as a regular SysTick interrupt once interrupts are re-enabled.
+ */
+extern "C" void vPortSuppressTicksAndSleep(TickType_t expectedIdleTicks) {
+    using namespace embedded;
+
+    u32 primask = disableInterrupts();
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        restoreInterrupts(primask);
+        return;
+    }
+
+    if (expectedIdleTicks > 0x7FFFFFFF) {
+        expectedIdleTicks = 0x7FFFFFFF;
+    }
+    u32 start = System::getTicks();
+    u32 wake = start + expectedIdleTicks;
+
+    // SoftTimer callbacks need their ticks even when no task waits
+    u32 timerWake;
+    if (SoftTimer::getNextExpiry(timerWake) && static_cast<i32>(timerWake - wake) < 0) {
+        wake = timerWake;
+    }
+
+    PROFILE_IDLE_BEGIN();
+    System::idleUntil(wake);
+    PROFILE_IDLE_END();
+
+    u32 skipped = System::getTicks() - start;
+    if (skipped != 0) {
+        vTaskStepTick(skipped);
+    }
+
+    restoreInterrupts(primask);
+}
+#endif
+
+#endif // USE_RTOS
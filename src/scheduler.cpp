@@ -0,0 +1,306 @@
+/**
+ * @file scheduler.cpp
+ * @brief Cooperative event-driven task scheduler implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "scheduler.hpp"
+#include "system.hpp"
+#include "profiler.hpp"
+#include "soft_timer.hpp"
+
+namespace embedded {
+
+static_assert((SCHEDULER_WHEEL_SLOTS & (SCHEDULER_WHEEL_SLOTS - 1)) == 0,
+              "SCHEDULER_WHEEL_SLOTS must be a power of two");
+
+namespace {
+
+constexpr u32 WHEEL_MASK = SCHEDULER_WHEEL_SLOTS - 1;
+
+// Wrap-safe "a is at or before b"
+inline bool notAfter(u32 a, u32 b) {
+    return static_cast<i32>(a - b) <= 0;
+}
+
+} // namespace
+
+// Static member initialization
+CCM_BSS Scheduler::Task*    Scheduler::s_wheel[SCHEDULER_WHEEL_SLOTS] = {};
+u32                         Scheduler::s_wheelTick = 0;
+Scheduler::Task*            Scheduler::s_ready = nullptr;
+Scheduler::Task* volatile   Scheduler::s_posted = nullptr;
+#if USE_RTOS
+Semaphore                   Scheduler::s_wakeSignal;
+#endif
+
+void Scheduler::init() {
+    for (size_t i = 0; i < SCHEDULER_WHEEL_SLOTS; i++) {
+        s_wheel[i] = nullptr;
+    }
+    s_ready = nullptr;
+    s_posted = nullptr;
+    s_wheelTick = System::getTicks();
+
+#if PROFILER_ENABLED
+    Profiler::reset();
+#endif
+}
+
+Status Scheduler::startPeriodic(Task* task, u32 periodMs, u32 delayMs) {
+    if (periodMs == 0) {
+        return Status::InvalidArg;
+    }
+    return start(task, periodMs, delayMs);
+}
+
+Status Scheduler::startOnce(Task* task, u32 delayMs) {
+    return start(task, 0, delayMs);
+}
+
+Status Scheduler::start(Task* task, u32 periodMs, u32 delayMs) {
+    if (task == nullptr || task->handler == nullptr) {
+        return Status::InvalidArg;
+    }
+    if (task->inWheel) {
+        return Status::Busy;
+    }
+
+    task->periodMs = periodMs;
+    task->deadline = System::getTicks() + delayMs;
+    insertWheel(task);
+
+    return Status::Ok;
+}
+
+void Scheduler::cancel(Task* task) {
+    task->periodMs = 0;
+
+    if (task->inWheel) {
+        removeWheel(task);
+    }
+    if (task->inReady) {
+        removeReady(task);
+    }
+
+    CriticalSection cs;
+    if (task->posted) {
+        for (Task* volatile* link = &s_posted; *link != nullptr; link = &(*link)->postNext) {
+            if (*link == task) {
+                *link = task->postNext;
+                break;
+            }
+        }
+        task->posted = false;
+    }
+}
+
+void Scheduler::post(Task* task) {
+    {
+        CriticalSection cs;
+        if (!task->posted) {
+            task->posted = true;
+            task->postNext = s_posted;
+            s_posted = task;
+        }
+    }
+
+#if USE_RTOS
+    s_wakeSignal.give();
+#endif
+}
+
+bool Scheduler::dispatch() {
+    u32 now = System::getTicks();
+    drainPosted(now);
+    advance(now);
+
+    Task* task = s_ready;
+    if (task == nullptr) {
+        return false;
+    }
+
+    s_ready = task->readyNext;
+    task->inReady = false;
+
+    // Latency: how long the task sat in the ready queue (tick resolution)
+    PROFILE_SCOPE_LATENCY(task->profile,
+                          (now - task->readyAt) * (System::getSystemClock() / TICK_RATE_HZ));
+    task->handler(task->context);
+
+    return true;
+}
+
+void Scheduler::run() {
+    while (true) {
+        if (dispatch()) {
+            continue;
+        }
+
+#if USE_RTOS
+        // Block the task until the next deadline; a post landing after
+        // the check leaves the semaphore given. SysTick keeps serving
+        // SoftTimer, and the kernel idles tickless when every task waits
+        // (idle time is accounted by the idle task, see rtos.cpp)
+        if (s_posted == nullptr) {
+            i32 wait = static_cast<i32>(nextDeadline() - System::getTicks());
+            s_wakeSignal.take(wait > 0 ? static_cast<u32>(wait) : 0);
+        }
+#else
+        // Re-check posted events with interrupts masked so that a post
+        // landing just before the sleep still wakes the core
+        u32 primask = disableInterrupts();
+        if (s_posted == nullptr) {
+            // Soft timer callbacks are due from SysTick: wake for them too
+            u32 wake = nextDeadline();
+            u32 timerWake;
+            if (SoftTimer::getNextExpiry(timerWake) && notAfter(timerWake, wake)) {
+                wake = timerWake;
+            }
+
+            PROFILE_IDLE_BEGIN();
+            System::idleUntil(wake);
+            PROFILE_IDLE_END();
+        }
+        restoreInterrupts(primask);
+#endif
+    }
+}
+
+void Scheduler::advance(u32 now) {
+    if (!notAfter(s_wheelTick, now)) {
+        return;
+    }
+
+    // Visit each elapsed slot once; after a long sleep that is the whole wheel
+    u32 steps = now - s_wheelTick + 1;
+    if (steps > SCHEDULER_WHEEL_SLOTS) {
+        steps = SCHEDULER_WHEEL_SLOTS;
+    }
+
+    u32 tick = s_wheelTick;
+    s_wheelTick = now + 1;
+
+    for (u32 i = 0; i < steps; i++, tick++) {
+        Task** link = &s_wheel[tick & WHEEL_MASK];
+        while (*link != nullptr) {
+            Task* task = *link;
+            if (!notAfter(task->deadline, now)) {
+                // Belongs to a later lap of the wheel
+                link = &task->wheelNext;
+                continue;
+            }
+
+            *link = task->wheelNext;
+            task->inWheel = false;
+
+            makeReady(task, task->deadline);
+
+            if (task->periodMs != 0) {
+                // Keep the phase, but skip periods that were missed entirely
+                task->deadline += task->periodMs;
+                if (notAfter(task->deadline, now)) {
+                    task->deadline += ((now - task->deadline) / task->periodMs + 1) * task->periodMs;
+                }
+                insertWheel(task);
+            }
+        }
+    }
+}
+
+void Scheduler::drainPosted(u32 now) {
+    Task* list;
+    {
+        CriticalSection cs;
+        list = s_posted;
+        s_posted = nullptr;
+        for (Task* task = list; task != nullptr; task = task->postNext) {
+            task->posted = false;
+        }
+    }
+
+    while (list != nullptr) {
+        Task* task = list;
+        list = task->postNext;
+        makeReady(task, now);
+    }
+}
+
+void Scheduler::insertWheel(Task* task) {
+    if (!notAfter(s_wheelTick, task->deadline)) {
+        // Already behind the wheel: due right away
+        makeReady(task, task->deadline);
+        if (task->periodMs == 0) {
+            return;
+        }
+
+        // Periodic: re-arm at the first period boundary the wheel has
+        // not passed yet, as advance() would have
+        u32 behind = s_wheelTick - 1 - task->deadline;
+        task->deadline += (behind / task->periodMs + 1) * task->periodMs;
+    }
+
+    Task** slot = &s_wheel[task->deadline & WHEEL_MASK];
+    task->wheelNext = *slot;
+    *slot = task;
+    task->inWheel = true;
+}
+
+void Scheduler::removeWheel(Task* task) {
+    for (Task** link = &s_wheel[task->deadline & WHEEL_MASK]; *link != nullptr; link = &(*link)->wheelNext) {
+        if (*link == task) {
+            *link = task->wheelNext;
+            break;
+        }
+    }
+    task->inWheel = false;
+}
+
+void Scheduler::makeReady(Task* task, u32 readyAt) {
+    if (task->inReady) {
+        return;
+    }
+
+    task->readyAt = readyAt;
+    task->inReady = true;
+
+    // Earliest deadline first; equal deadlines keep FIFO order
+    Task** link = &s_ready;
+    while (*link != nullptr && notAfter((*link)->readyAt, readyAt)) {
+        link = &(*link)->readyNext;
+    }
+    task->readyNext = *link;
+    *link = task;
+}
+
+void Scheduler::removeReady(Task* task) {
+    for (Task** link = &s_ready; *link != nullptr; link = &(*link)->readyNext) {
+        if (*link == task) {
+            *link = task->readyNext;
+            break;
+        }
+    }
+    task->inReady = false;
+}
+
+u32 Scheduler::nextDeadline() {
+    if (s_ready != nullptr) {
+        return s_wheelTick;
+    }
+
+    for (u32 i = 0; i < SCHEDULER_WHEEL_SLOTS; i++) {
+        u32 tick = s_wheelTick + i;
+        for (Task* task = s_wheel[tick & WHEEL_MASK]; task != nullptr; task = task->wheelNext) {
+            if (task->deadline == tick) {
+                return tick;
+            }
+        }
+    }
+
+    // Nothing within one lap: wake up to look at the next one
+    return s_wheelTick + SCHEDULER_WHEEL_SLOTS;
+}
+
+} // namespace embedded
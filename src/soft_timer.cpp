@@ -0,0 +1,125 @@
+/**
+ * @file soft_timer.cpp
+ * @brief Software timers driven from SysTick implementation
+ * @author Embedded Firmware Project
+ * @date 2016
+ * @license MIT
+ */
+
+#include "soft_timer.hpp"
+
+namespace embedded {
+
+// Static member initialization
+CCM_BSS SoftTimer::Timer* SoftTimer::s_head = nullptr;
+
+void SoftTimer::init() {
+    CriticalSection cs;
+    s_head = nullptr;
+}
+
+Status SoftTimer::startOnce(Timer* timer, u32 delayMs) {
+    return start(timer, 0, (delayMs != 0) ? delayMs : 1);
+}
+
+Status SoftTimer::startPeriodic(Timer* timer, u32 periodMs) {
+    if (periodMs == 0) {
+        return Status::InvalidArg;
+    }
+    return start(timer, periodMs, periodMs);
+}
+
+Status SoftTimer::start(Timer* timer, u32 periodMs, u32 delayMs) {
+    if (timer == nullptr || timer->callback == nullptr) {
+        return Status::InvalidArg;
+    }
+
+    CriticalSection cs;
+    if (timer->active) {
+        return Status::Busy;
+    }
+
+    timer->periodMs = periodMs;
+    timer->expiry = System::getTicks64() + delayMs;
+    insert(timer);
+
+    return Status::Ok;
+}
+
+void SoftTimer::stop(Timer* timer) {
+    CriticalSection cs;
+    if (!timer->active) {
+        return;
+    }
+
+    for (Timer** link = &s_head; *link != nullptr; link = &(*link)->next) {
+        if (*link == timer) {
+            *link = timer->next;
+            break;
+        }
+    }
+    timer->active = false;
+    timer->periodMs = 0;
+}
+
+bool SoftTimer::isActive(const Timer* timer) {
+    return timer->active;
+}
+
+bool SoftTimer::getNextExpiry(u32& tick) {
+    CriticalSection cs;
+    if (s_head == nullptr) {
+        return false;
+    }
+
+    u64 now = System::getTicks64();
+    u64 ahead = (s_head->expiry > now) ? s_head->expiry - now : 0;
+    if (ahead > 0x7FFFFFFF) {
+        ahead = 0x7FFFFFFF;
+    }
+    tick = static_cast<u32>(now + ahead);
+
+    return true;
+}
+
+void SoftTimer::insert(Timer* timer) {
+    // Equal expiries keep FIFO order
+    Timer** link = &s_head;
+    while (*link != nullptr && (*link)->expiry <= timer->expiry) {
+        link = &(*link)->next;
+    }
+    timer->next = *link;
+    *link = timer;
+    timer->active = true;
+}
+
+void SoftTimer::process(u64 now) {
+    while (true) {
+        Timer* timer;
+        {
+            CriticalSection cs;
+            timer = s_head;
+            if (timer == nullptr || timer->expiry > now) {
+                return;
+            }
+
+            s_head = timer->next;
+            timer->active = false;
+
+            if (timer->periodMs != 0) {
+                // Keep the phase, but skip periods that were missed entirely
+                timer->expiry += timer->periodMs;
+                if (timer->expiry <= now) {
+                    // Rare catch-up: next period boundary after now
+                    timer->expiry += ((now - timer->expiry) / timer->periodMs + 1) * timer->periodMs;
+                }
+                insert(timer);
+            }
+        }
+
+        // Unmasked: the callback may start or stop timers, itself included
+        timer->callback(timer->context);
+    }
+}
+
+} // namespace embedded
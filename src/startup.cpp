@@ -10,8 +10,14 @@
  * - Reset handler
  * - Default interrupt handlers
  * - Memory initialization
+ * 
+ * Boot order is arranged for a short power-on-to-main time: the HSE
+ * crystal starts while memory is initialized with LDM/STM bursts, and
+ * the PLL locks while static constructors run.
  */
 
+#include "system.hpp"
+
 #include <cstdint>
 
 /*============================================================================
@@ -23,6 +29,14 @@ extern uint32_t _sdata;         // Start of .data section
 extern uint32_t _edata;         // End of .data section
 extern uint32_t _sbss;          // Start of .bss section
 extern uint32_t _ebss;          // End of .bss section
+extern uint32_t _siramfunc;     // Start of .ramfunc code in flash
+extern uint32_t _sramfunc;      // Start of .ramfunc section
+extern uint32_t _eramfunc;      // End of .ramfunc section
+extern uint32_t _siccmram;      // Start of .ccmram initialization values
+extern uint32_t _sccmram;       // Start of .ccmram section
+extern uint32_t _eccmram;       // End of .ccmram section
+extern uint32_t _sccmbss;       // Start of .ccmbss section
+extern uint32_t _eccmbss;       // End of .ccmbss section
 
 /*============================================================================
  * Function Prototypes
@@ -78,6 +92,25 @@ extern "C" {
     void I2C2_ER_IRQHandler(void)       __attribute__((weak, alias("Default_Handler")));
     void SPI1_IRQHandler(void)          __attribute__((weak, alias("Default_Handler")));
     void SPI2_IRQHandler(void)          __attribute__((weak, alias("Default_Handler")));
+    void EXTI15_10_IRQHandler(void)     __attribute__((weak, alias("Default_Handler")));
+    void DMA1_Stream7_IRQHandler(void)  __attribute__((weak, alias("Default_Handler")));
+    void TIM5_IRQHandler(void)          __attribute__((weak, alias("Default_Handler")));
+    void SPI3_IRQHandler(void)          __attribute__((weak, alias("Default_Handler")));
+    void UART4_IRQHandler(void)         __attribute__((weak, alias("Default_Handler")));
+    void UART5_IRQHandler(void)         __attribute__((weak, alias("Default_Handler")));
+    void TIM6_DAC_IRQHandler(void)      __attribute__((weak, alias("Default_Handler")));
+    void TIM7_IRQHandler(void)          __attribute__((weak, alias("Default_Handler")));
+    void DMA2_Stream0_IRQHandler(void)  __attribute__((weak, alias("Default_Handler")));
+    void DMA2_Stream1_IRQHandler(void)  __attribute__((weak, alias("Default_Handler")));
+    void DMA2_Stream2_IRQHandler(void)  __attribute__((weak, alias("Default_Handler")));
+    void DMA2_Stream3_IRQHandler(void)  __attribute__((weak, alias("Default_Handler")));
+    void DMA2_Stream4_IRQHandler(void)  __attribute__((weak, alias("Default_Handler")));
+    void DMA2_Stream5_IRQHandler(void)  __attribute__((weak, alias("Default_Handler")));
+    void DMA2_Stream6_IRQHandler(void)  __attribute__((weak, alias("Default_Handler")));
+    void DMA2_Stream7_IRQHandler(void)  __attribute__((weak, alias("Default_Handler")));
+    void USART6_IRQHandler(void)        __attribute__((weak, alias("Default_Handler")));
+    void I2C3_EV_IRQHandler(void)       __attribute__((weak, alias("Default_Handler")));
+    void I2C3_ER_IRQHandler(void)       __attribute__((weak, alias("Default_Handler")));
 }
 
 /*============================================================================
@@ -146,24 +179,133 @@ void (* const g_pfnVectors[])(void) = {
     USART1_IRQHandler,
     USART2_IRQHandler,
     USART3_IRQHandler,
+    EXTI15_10_IRQHandler,
+    nullptr,                // Reserved
+    nullptr,                // Reserved
+    nullptr,                // Reserved
+    nullptr,                // Reserved
+    nullptr,                // Reserved
+    nullptr,                // Reserved
+    DMA1_Stream7_IRQHandler,
+    nullptr,                // Reserved
+    nullptr,                // Reserved
+    TIM5_IRQHandler,
+    SPI3_IRQHandler,
+    UART4_IRQHandler,
+    UART5_IRQHandler,
+    TIM6_DAC_IRQHandler,
+    TIM7_IRQHandler,
+    DMA2_Stream0_IRQHandler,
+    DMA2_Stream1_IRQHandler,
+    DMA2_Stream2_IRQHandler,
+    DMA2_Stream3_IRQHandler,
+    DMA2_Stream4_IRQHandler,
+    nullptr,                // Reserved
+    nullptr,                // Reserved
+    nullptr,                // Reserved
+    nullptr,                // Reserved
+    nullptr,                // Reserved
+    nullptr,                // Reserved
+    nullptr,                // Reserved
+    DMA2_Stream5_IRQHandler,
+    DMA2_Stream6_IRQHandler,
+    DMA2_Stream7_IRQHandler,
+    USART6_IRQHandler,
+    I2C3_EV_IRQHandler,
+    I2C3_ER_IRQHandler,
 };
 
+/*============================================================================
+ * Memory Initialization
+ *===========================================================================*/
+/**
+ * @brief Copy words, 32 bytes per LDM/STM pair
+ * 
+ * Plain C loops would be turned into memcpy() calls, which are not
+ * linked (libc is discarded) and not usable before .data exists.
+ */
+__attribute__((always_inline))
+static inline void copyWords(uint32_t* dst, const uint32_t* src, const uint32_t* end) {
+    while (end - dst >= 8) {
+        __asm volatile (
+            "ldmia %[src]!, {r2-r5}\n\t"
+            "stmia %[dst]!, {r2-r5}\n\t"
+            "ldmia %[src]!, {r2-r5}\n\t"
+            "stmia %[dst]!, {r2-r5}"
+            : [src] "+r" (src), [dst] "+r" (dst)
+            :
+            : "r2", "r3", "r4", "r5", "memory"
+        );
+    }
+    while (dst < end) {
+        __asm volatile (
+            "ldr r2, [%[src]], #4\n\t"
+            "str r2, [%[dst]], #4"
+            : [src] "+r" (src), [dst] "+r" (dst)
+            :
+            : "r2", "memory"
+        );
+    }
+}
+
+/**
+ * @brief Zero words, 32 bytes per STM pair
+ */
+__attribute__((always_inline))
+static inline void fillWords(uint32_t* dst, const uint32_t* end) {
+    uint32_t left;
+
+    // One block: the zeroed registers must survive between the bursts
+    __asm volatile (
+        "movs r2, #0\n\t"
+        "movs r3, #0\n\t"
+        "movs r4, #0\n\t"
+        "movs r5, #0\n\t"
+        "b 2f\n"
+        "1:\n\t"
+        "stmia %[dst]!, {r2-r5}\n\t"
+        "stmia %[dst]!, {r2-r5}\n"
+        "2:\n\t"
+        "subs %[left], %[end], %[dst]\n\t"
+        "cmp %[left], #32\n\t"
+        "bhs 1b\n"
+        "3:\n\t"
+        "cmp %[dst], %[end]\n\t"
+        "bhs 4f\n\t"
+        "str r2, [%[dst]], #4\n\t"
+        "b 3b\n"
+        "4:"
+        : [dst] "+r" (dst), [left] "=&r" (left)
+        : [end] "r" (end)
+        : "r2", "r3", "r4", "r5", "cc", "memory"
+    );
+}
+
 /*============================================================================
  * Reset Handler
  *===========================================================================*/
 void Reset_Handler(void) {
-    // Copy .data section from flash to RAM
-    uint32_t* src = &_sidata;
-    uint32_t* dst = &_sdata;
-    while (dst < &_edata) {
-        *dst++ = *src++;
-    }
+    // FPU access (CP10/CP11) before any code may use it (hard-float ABI)
+    volatile uint32_t* CPACR = reinterpret_cast<volatile uint32_t*>(0xE000ED88);
+    *CPACR |= (0xFU << 20);
+    __asm volatile ("dsb" ::: "memory");
+    __asm volatile ("isb" ::: "memory");
 
-    // Zero fill .bss section
-    dst = &_sbss;
-    while (dst < &_ebss) {
-        *dst++ = 0;
-    }
+    // Crystal starts up while memory is initialized
+    embedded::System::startClocks();
+
+    copyWords(&_sdata, &_sidata, &_edata);
+    copyWords(&_sramfunc, &_siramfunc, &_eramfunc);
+    copyWords(&_sccmram, &_siccmram, &_eccmram);
+    fillWords(&_sbss, &_ebss);
+    fillWords(&_sccmbss, &_eccmbss);
+
+    // Make sure the copied code is visible to instruction fetch
+    __asm volatile ("dsb" ::: "memory");
+    __asm volatile ("isb" ::: "memory");
+
+    // PLL locks while the constructors run; System::init() switches over
+    embedded::System::startPll();
 
     // Call static constructors
     extern void (*__preinit_array_start[])(void);
@@ -7,16 +7,142 @@
  */
 
 #include "system.hpp"
+#include "profiler.hpp"
+#include "soft_timer.hpp"
+#include "rtos.hpp"
 
 namespace embedded {
 
 // Static member initialization
-volatile u32 System::s_tickCount = 0;
+CCM_BSS volatile u32 System::s_tickCount = 0;
+CCM_BSS volatile u32 System::s_tickHigh = 0;
+CCM_BSS u32 System::s_cycleHigh = 0;
+CCM_BSS u32 System::s_cycleLast = 0;
+ClockProfile System::s_clockProfile = ClockProfile::Performance;
+u32 System::s_systemClock = SYSTEM_CLOCK_HZ;
+u32 System::s_apb1Clock = APB1_CLOCK_HZ;
+u32 System::s_apb2Clock = APB2_CLOCK_HZ;
+u32 System::s_cyclesPerUs = SYSTEM_CLOCK_HZ / 1000000;
+CCM_BSS u64 System::s_microsBase = 0;
+CCM_BSS u64 System::s_cyclesBase = 0;
+CCM_BSS ClockListener* System::s_clockListeners = nullptr;
+
+namespace {
+
+// SysTick registers
+volatile u32* const SYST_CSR = reinterpret_cast<volatile u32*>(0xE000E010);
+volatile u32* const SYST_RVR = reinterpret_cast<volatile u32*>(0xE000E014);
+volatile u32* const SYST_CVR = reinterpret_cast<volatile u32*>(0xE000E018);
+
+constexpr u32 SYST_CSR_ENABLE    = (1 << 0);
+constexpr u32 SYST_CSR_COUNTFLAG = (1 << 16);
+constexpr u32 SYST_MAX_RELOAD    = 0x00FFFFFF;
+
+// DWT cycle counter
+volatile u32* const DWT_CYCCNT = reinterpret_cast<volatile u32*>(0xE0001004);
+
+// RCC and flash interface
+volatile u32* const RCC_CR      = reinterpret_cast<volatile u32*>(0x40023800);
+volatile u32* const RCC_PLLCFGR = reinterpret_cast<volatile u32*>(0x40023804);
+volatile u32* const RCC_CFGR    = reinterpret_cast<volatile u32*>(0x40023808);
+volatile u32* const FLASH_ACR   = reinterpret_cast<volatile u32*>(0x40023C00);
+
+constexpr u32 RCC_CR_HSERDY     = BIT(17);
+constexpr u32 RCC_CR_HSEON      = BIT(16);
+constexpr u32 RCC_CR_PLLON      = BIT(24);
+constexpr u32 RCC_CR_PLLRDY     = BIT(25);
+constexpr u32 RCC_PLLCFGR_HSE   = BIT(22);
+constexpr u32 RCC_CFGR_SW_HSI   = 0;
+constexpr u32 RCC_CFGR_SW_PLL   = 2;
+constexpr u32 RCC_CFGR_SW_MASK  = 3;
+constexpr u32 RCC_CFGR_SWS_MASK = (3 << 2);
+constexpr u32 RCC_CFGR_HPRE_DIV2  = (8 << 4);
+constexpr u32 RCC_CFGR_HPRE_MASK  = (0xF << 4);
+constexpr u32 RCC_CFGR_PPRE1_DIV2 = (4 << 10);
+constexpr u32 RCC_CFGR_PPRE1_DIV4 = (5 << 10);
+constexpr u32 RCC_CFGR_PPRE1_DIV16 = (7 << 10);
+constexpr u32 RCC_CFGR_PPRE2_DIV2 = (4 << 13);
+constexpr u32 RCC_CFGR_PPRE2_DIV16 = (7 << 13);
+constexpr u32 RCC_CFGR_PPRE_MASK  = (7 << 10) | (7 << 13);
+
+constexpr u32 FLASH_ACR_LATENCY_MASK = 0x7;
+constexpr u32 FLASH_ACR_PRFTEN  = BIT(8);
+constexpr u32 FLASH_ACR_ICEN    = BIT(9);
+constexpr u32 FLASH_ACR_DCEN    = BIT(10);
+
+// PLL: 1 MHz VCO input, SYSCLK = VCO / 2, 48 MHz USB/SDIO clock
+constexpr u32 PLL_N = 2 * (SYSTEM_CLOCK_HZ / 1000000);
+constexpr u32 PLL_Q = (PLL_N + 47) / 48;
+constexpr u32 PLL_CONFIG = (PLL_N << 6) | (0 << 16) /* P = 2 */ | (PLL_Q << 24);
+constexpr u32 PLL_M_HSE = HSE_CLOCK_HZ / 1000000;
+constexpr u32 PLL_M_HSI = 16;
+
+static_assert(PLL_N >= 50 && PLL_N <= 432, "SYSTEM_CLOCK_HZ out of PLL range");
+
+static_assert(APB1_CLOCK_HZ <= 42000000 && APB2_CLOCK_HZ <= 84000000,
+              "SYSTEM_CLOCK_HZ too high for the APB dividers");
+
+// One wait state per 30 MHz at 2.7-3.6 V
+constexpr u32 flashLatency(u32 hclk) {
+    return (hclk - 1) / 30000000;
+}
+
+inline void setFlashLatency(u32 latency) {
+    *FLASH_ACR = (*FLASH_ACR & ~FLASH_ACR_LATENCY_MASK) | latency;
+    while ((*FLASH_ACR & FLASH_ACR_LATENCY_MASK) != latency) {}
+}
+
+/**
+ * @brief Clock tree settings of one ClockProfile
+ */
+struct ClockSettings {
+    u32 hclk;
+    u32 pclk1;
+    u32 pclk2;
+    u32 cfgr;                           ///< HPRE, PPRE1, PPRE2 and SW fields
+    u32 latency;                        ///< Flash wait states at hclk
+};
+
+// Indexed by ClockProfile; Balanced halves HCLK so the PLL keeps running
+const ClockSettings CLOCK_PROFILES[] = {
+    { SYSTEM_CLOCK_HZ, SYSTEM_CLOCK_HZ / 4, SYSTEM_CLOCK_HZ / 2,
+      RCC_CFGR_PPRE1_DIV4 | RCC_CFGR_PPRE2_DIV2 | RCC_CFGR_SW_PLL,
+      flashLatency(SYSTEM_CLOCK_HZ) },
+    { SYSTEM_CLOCK_HZ / 2, SYSTEM_CLOCK_HZ / 4, SYSTEM_CLOCK_HZ / 2,
+      RCC_CFGR_HPRE_DIV2 | RCC_CFGR_PPRE1_DIV2 | RCC_CFGR_SW_PLL,
+      flashLatency(SYSTEM_CLOCK_HZ / 2) },
+    { HSI_CLOCK_HZ, HSI_CLOCK_HZ, HSI_CLOCK_HZ,
+      RCC_CFGR_SW_HSI,
+      flashLatency(HSI_CLOCK_HZ) }
+};
+
+// NVIC and system handler priority registers
+volatile u32* const NVIC_ISER = reinterpret_cast<volatile u32*>(0xE000E100);
+volatile u32* const NVIC_ICER = reinterpret_cast<volatile u32*>(0xE000E180);
+volatile u32* const NVIC_ISPR = reinterpret_cast<volatile u32*>(0xE000E200);
+volatile u32* const NVIC_ICPR = reinterpret_cast<volatile u32*>(0xE000E280);
+volatile u8*  const NVIC_IPR  = reinterpret_cast<volatile u8*>(0xE000E400);
+volatile u8*  const SCB_SHPR  = reinterpret_cast<volatile u8*>(0xE000ED18);
+
+inline u32 irqIndex(IrqNumber irq) {
+    return static_cast<u32>(static_cast<i16>(irq));
+}
+
+// Priority register of an exception: SHPR for system exceptions (4..15)
+inline volatile u8* priorityRegister(IrqNumber irq) {
+    i16 n = static_cast<i16>(irq);
+    return (n < 0) ? &SCB_SHPR[n + 16 - 4] : &NVIC_IPR[n];
+}
+
+} // namespace
 
 Status System::init() {
     // Initialize system clocks
     initClocks();
     
+    // Start the cycle counter before anything wants timestamps
+    initDwt();
+    
     // Initialize SysTick timer
     initSysTick();
     
@@ -42,24 +168,159 @@ u32 System::getTicks() {
     return s_tickCount;
 }
 
+u64 System::getTicks64() {
+    // advanceTicks() updates both words with interrupts masked; a reader
+    // preempted between its two loads sees the high word change
+    u32 high;
+    u32 low;
+    do {
+        high = s_tickHigh;
+        low = s_tickCount;
+    } while (high != s_tickHigh);
+
+    return (static_cast<u64>(high) << 32) | low;
+}
+
+void System::advanceTicks(u32 ticks) {
+    u32 old = s_tickCount;
+    u32 low = old + ticks;
+    if (low >= old) {
+        s_tickCount = low;
+        return;
+    }
+
+    CriticalSection cs;
+    s_tickHigh = s_tickHigh + 1;
+    s_tickCount = low;
+}
+
 void System::delayMs(u32 ms) {
-    u32 start = s_tickCount;
-    while ((s_tickCount - start) < ms) {
+#if USE_RTOS
+    // Block the calling task; other tasks run or the core sleeps tickless
+    if (Rtos::isRunning() && !Rtos::inInterrupt()) {
+        vTaskDelay(pdMS_TO_TICKS(ms));
+        return;
+    }
+#endif
+
+    Deadline deadline(ms);
+    while (!deadline.expired()) {
+#if LOW_POWER_MODE
+        idleUntil(s_tickCount + deadline.remaining());
+#else
         __asm volatile ("nop");
+#endif
     }
 }
 
 void System::delayUs(u32 us) {
-    // Approximate delay using NOP loops
-    // Calibrated for 168 MHz system clock
-    u32 cycles = (SYSTEM_CLOCK_HZ / 1000000) * us / 4;
-    while (cycles--) {
+    u32 start = *DWT_CYCCNT;
+    u32 cycles = us * s_cyclesPerUs;
+    while ((*DWT_CYCCNT - start) < cycles) {
         __asm volatile ("nop");
     }
 }
 
+u32 System::getCycles() {
+    return *DWT_CYCCNT;
+}
+
+u64 System::getCycles64() {
+    CriticalSection cs;
+    u32 now = *DWT_CYCCNT;
+    if (now < s_cycleLast) {
+        s_cycleHigh++;
+    }
+    s_cycleLast = now;
+    return (static_cast<u64>(s_cycleHigh) << 32) | now;
+}
+
+u64 System::getMicros() {
+    CriticalSection cs;
+    return s_microsBase + (getCycles64() - s_cyclesBase) / s_cyclesPerUs;
+}
+
 u32 System::getSystemClock() {
-    return SYSTEM_CLOCK_HZ;
+    return s_systemClock;
+}
+
+u32 System::getApb1Clock() {
+    return s_apb1Clock;
+}
+
+u32 System::getApb2Clock() {
+    return s_apb2Clock;
+}
+
+Status System::setClockProfile(ClockProfile profile) {
+    if (static_cast<u8>(profile) > static_cast<u8>(ClockProfile::LowPower)) {
+        return Status::InvalidArg;
+    }
+    if (profile == s_clockProfile) {
+        return Status::Ok;
+    }
+
+    if (profile != ClockProfile::LowPower && (*RCC_CR & RCC_CR_PLLRDY) == 0) {
+        // Restart what LowPower stopped; the core keeps running on HSI
+        startClocks();
+        startPll();
+        u32 polls = 0;
+        while ((*RCC_CR & RCC_CR_PLLRDY) == 0) {
+            if (++polls >= CLOCK_PLL_TIMEOUT) {
+                *RCC_CR &= ~(RCC_CR_PLLON | RCC_CR_HSEON);
+                return Status::Timeout;
+            }
+        }
+    }
+
+    {
+        CriticalSection cs;
+
+        // Rebase getMicros() on the cycles counted at the old rate
+        u64 cycles = getCycles64();
+        s_microsBase += (cycles - s_cyclesBase) / s_cyclesPerUs;
+        s_cyclesBase = cycles;
+
+        applyClockProfile(profile);
+    }
+
+    if (profile == ClockProfile::LowPower) {
+        *RCC_CR &= ~(RCC_CR_PLLON | RCC_CR_HSEON);
+    }
+
+    for (ClockListener* listener = s_clockListeners; listener != nullptr; ) {
+        ClockListener* next = listener->next;   // Callback may remove itself
+        listener->callback(listener->context);
+        listener = next;
+    }
+
+    return Status::Ok;
+}
+
+ClockProfile System::getClockProfile() {
+    return s_clockProfile;
+}
+
+void System::addClockListener(ClockListener* listener) {
+    CriticalSection cs;
+    for (ClockListener* entry = s_clockListeners; entry != nullptr; entry = entry->next) {
+        if (entry == listener) {
+            return;
+        }
+    }
+    listener->next = s_clockListeners;
+    s_clockListeners = listener;
+}
+
+void System::removeClockListener(ClockListener* listener) {
+    CriticalSection cs;
+    for (ClockListener** link = &s_clockListeners; *link != nullptr; link = &(*link)->next) {
+        if (*link == listener) {
+            *link = listener->next;
+            listener->next = nullptr;
+            return;
+        }
+    }
 }
 
 void System::sleep() {
@@ -80,6 +341,90 @@ void System::deepSleep() {
     *SCR &= ~(1 << 2);
 }
 
+void System::idleUntil(u32 wakeTick) {
+#if LOW_POWER_MODE
+    const u32 cyclesPerTick = s_systemClock / TICK_RATE_HZ;
+    const u32 maxTicks = SYST_MAX_RELOAD / cyclesPerTick;
+    volatile u32* ICSR = reinterpret_cast<volatile u32*>(0xE000ED04);
+
+    u32 primask = disableInterrupts();
+
+    i32 remaining = static_cast<i32>(wakeTick - s_tickCount);
+    if (remaining <= 0) {
+        restoreInterrupts(primask);
+        return;
+    }
+    if (remaining < 2) {
+        // Deadline is the next tick: not worth reprogramming
+        sleep();
+        restoreInterrupts(primask);
+        return;
+    }
+
+    u32 ticks = static_cast<u32>(remaining);
+    if (ticks > maxTicks) {
+        ticks = maxTicks;
+    }
+
+    // Stop SysTick; give up if a tick became pending meanwhile
+    *SYST_CSR &= ~SYST_CSR_ENABLE;
+    if (*ICSR & (1 << 26)) {
+        *SYST_CSR |= SYST_CSR_ENABLE;
+        restoreInterrupts(primask);
+        return;
+    }
+
+    // Fire once the running tick and (ticks - 1) further periods elapse
+    u32 current = *SYST_CVR;
+    u32 reload = current + (ticks - 1) * cyclesPerTick - 1;
+    *SYST_RVR = reload;
+    *SYST_CVR = 0;
+    *SYST_CSR |= SYST_CSR_ENABLE;
+
+    sleep();
+
+    u32 csr = *SYST_CSR;
+    *SYST_CSR = csr & ~SYST_CSR_ENABLE;
+    u32 elapsed = reload - *SYST_CVR;
+
+    u32 elapsedTicks;
+    u32 nextReload;
+    if (csr & SYST_CSR_COUNTFLAG) {
+        // Deadline reached: the pending SysTick interrupt adds the last tick
+        elapsedTicks = ticks - 1;
+        nextReload = (elapsed < cyclesPerTick) ? cyclesPerTick - elapsed : cyclesPerTick;
+    } else if (elapsed < current) {
+        // Woken before the running tick even completed
+        elapsedTicks = 0;
+        nextReload = current - elapsed;
+    } else {
+        // Woken early by another interrupt
+        u32 sinceFirst = elapsed - current;
+        elapsedTicks = 1 + sinceFirst / cyclesPerTick;
+        nextReload = cyclesPerTick - (sinceFirst % cyclesPerTick);
+    }
+
+    // A reload of zero would stop the counter: fold it into the next period
+    if (nextReload < 2) {
+        nextReload += cyclesPerTick;
+        elapsedTicks++;
+    }
+
+    advanceTicks(elapsedTicks);
+
+    // Finish the partial tick, then resume the regular period
+    *SYST_RVR = nextReload - 1;
+    *SYST_CVR = 0;
+    *SYST_CSR |= SYST_CSR_ENABLE;
+    *SYST_RVR = cyclesPerTick - 1;
+
+    restoreInterrupts(primask);
+#else
+    UNUSED(wakeTick);
+    sleep();
+#endif
+}
+
 void System::getUniqueId(u32* id) {
     // STM32F4 unique device ID registers
     volatile u32* UID_BASE = reinterpret_cast<volatile u32*>(0x1FFF7A10);
@@ -101,30 +446,85 @@ Status System::disablePeripheralClock(u32 peripheral) {
     return Status::Ok;
 }
 
+void System::startClocks() {
+    // Prefetch and ART caches speed up the rest of the boot at 16 MHz HSI too
+    *FLASH_ACR = (*FLASH_ACR & FLASH_ACR_LATENCY_MASK) |
+                 FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN;
+    *RCC_CR |= RCC_CR_HSEON;
+}
+
+void System::startPll() {
+    if (*RCC_CR & RCC_CR_PLLON) {
+        return;
+    }
+
+    u32 source = PLL_M_HSI;
+    for (u32 i = 0; i < CLOCK_HSE_TIMEOUT; i++) {
+        if (*RCC_CR & RCC_CR_HSERDY) {
+            source = RCC_PLLCFGR_HSE | PLL_M_HSE;
+            break;
+        }
+    }
+    if ((source & RCC_PLLCFGR_HSE) == 0) {
+        // No crystal: run from HSI rather than not at all
+        *RCC_CR &= ~RCC_CR_HSEON;
+    }
+
+    *RCC_PLLCFGR = PLL_CONFIG | source;
+    *RCC_CR |= RCC_CR_PLLON;
+}
+
 void System::initClocks() {
-    // Clock initialization for STM32F4 @ 168 MHz
-    // Using external 8 MHz crystal with PLL
-    
-    // This is a simplified example - full implementation would:
-    // 1. Enable HSE (High Speed External) oscillator
-    // 2. Wait for HSE ready
-    // 3. Configure PLL (M, N, P, Q dividers)
-    // 4. Enable PLL
-    // 5. Wait for PLL ready
-    // 6. Configure flash latency
-    // 7. Select PLL as system clock
-    // 8. Configure AHB, APB1, APB2 prescalers
+    // Normally started by Reset_Handler; lock overlaps the C++ runtime init
+    if ((*RCC_CR & RCC_CR_PLLON) == 0) {
+        startClocks();
+        startPll();
+    }
+    while ((*RCC_CR & RCC_CR_PLLRDY) == 0) {}
+
+    applyClockProfile(ClockProfile::Performance);
+}
+
+void System::applyClockProfile(ClockProfile profile) {
+    const ClockSettings& next = CLOCK_PROFILES[static_cast<u8>(profile)];
+    u32 latency = *FLASH_ACR & FLASH_ACR_LATENCY_MASK;
+
+    // Wait states before the clock goes up
+    if (next.latency > latency) {
+        setFlashLatency(next.latency);
+    }
+
+    // Slowest APB dividers while HCLK changes, so neither bus overshoots
+    *RCC_CFGR = (*RCC_CFGR & ~RCC_CFGR_PPRE_MASK) | RCC_CFGR_PPRE1_DIV16 | RCC_CFGR_PPRE2_DIV16;
+    *RCC_CFGR = (*RCC_CFGR & ~(RCC_CFGR_HPRE_MASK | RCC_CFGR_SW_MASK)) |
+                (next.cfgr & (RCC_CFGR_HPRE_MASK | RCC_CFGR_SW_MASK));
+    const u32 sws = (next.cfgr & RCC_CFGR_SW_MASK) << 2;
+    while ((*RCC_CFGR & RCC_CFGR_SWS_MASK) != sws) {}
+    *RCC_CFGR = (*RCC_CFGR & ~RCC_CFGR_PPRE_MASK) | (next.cfgr & RCC_CFGR_PPRE_MASK);
+
+    // ... and only removed once it is down
+    if (next.latency < latency) {
+        setFlashLatency(next.latency);
+    }
+
+    s_clockProfile = profile;
+    s_systemClock = next.hclk;
+    s_apb1Clock = next.pclk1;
+    s_apb2Clock = next.pclk2;
+    s_cyclesPerUs = next.hclk / 1000000;
+
+    if (*SYST_CSR & SYST_CSR_ENABLE) {
+        *SYST_RVR = (next.hclk / TICK_RATE_HZ) - 1;
+        *SYST_CVR = 0;
+    }
 }
 
 void System::initSysTick() {
+    SoftTimer::init();
+
     // Configure SysTick for 1ms interrupts
-    // SysTick registers
-    volatile u32* SYST_CSR = reinterpret_cast<volatile u32*>(0xE000E010);
-    volatile u32* SYST_RVR = reinterpret_cast<volatile u32*>(0xE000E014);
-    volatile u32* SYST_CVR = reinterpret_cast<volatile u32*>(0xE000E018);
-    
     // Calculate reload value for 1ms tick
-    u32 reloadValue = (SYSTEM_CLOCK_HZ / TICK_RATE_HZ) - 1;
+    u32 reloadValue = (s_systemClock / TICK_RATE_HZ) - 1;
     
     // Set reload value
     *SYST_RVR = reloadValue;
@@ -138,17 +538,93 @@ void System::initSysTick() {
                 (1 << 2);   // Use processor clock
 }
 
+void System::initDwt() {
+    volatile u32* DEMCR = reinterpret_cast<volatile u32*>(0xE000EDFC);
+    volatile u32* DWT_CTRL = reinterpret_cast<volatile u32*>(0xE0001000);
+    volatile u32* DWT_LAR = reinterpret_cast<volatile u32*>(0xE0001FB0);
+
+    // Enable trace block (TRCENA), unlock DWT and start CYCCNT
+    *DEMCR |= (1 << 24);
+    *DWT_LAR = 0xC5ACCE55;
+    *DWT_CYCCNT = 0;
+    *DWT_CTRL |= (1 << 0);
+
+    s_cycleHigh = 0;
+    s_cycleLast = 0;
+    s_microsBase = 0;
+    s_cyclesBase = 0;
+}
+
 void System::initNvic() {
     // Set priority grouping (4 bits preemption, 0 bits subpriority)
     volatile u32* AIRCR = reinterpret_cast<volatile u32*>(0xE000ED0C);
     *AIRCR = (0x5FA << 16) | (3 << 8);
+
+    // Keep the most urgent level free for time-critical handlers
+    setIrqPriority(IrqNumber::SysTick, IrqPriority::High);
+    setIrqPriority(IrqNumber::PendSV, IrqPriority::Lowest);
+}
+
+void System::enableIrq(IrqNumber irq) {
+    u32 n = irqIndex(irq);
+    NVIC_ISER[n / 32] = BIT(n % 32);
+}
+
+void System::disableIrq(IrqNumber irq) {
+    u32 n = irqIndex(irq);
+    NVIC_ICER[n / 32] = BIT(n % 32);
+    DSB();
+    ISB();
+}
+
+bool System::isIrqEnabled(IrqNumber irq) {
+    u32 n = irqIndex(irq);
+    return (NVIC_ISER[n / 32] & BIT(n % 32)) != 0;
+}
+
+void System::setIrqPriority(IrqNumber irq, IrqPriority priority) {
+    *priorityRegister(irq) = irqPriorityValue(priority);
+}
+
+u8 System::getIrqPriority(IrqNumber irq) {
+    return *priorityRegister(irq);
+}
+
+void System::setIrqPending(IrqNumber irq) {
+    u32 n = irqIndex(irq);
+    NVIC_ISPR[n / 32] = BIT(n % 32);
+}
+
+void System::clearIrqPending(IrqNumber irq) {
+    u32 n = irqIndex(irq);
+    NVIC_ICPR[n / 32] = BIT(n % 32);
+}
+
+bool System::isIrqPending(IrqNumber irq) {
+    u32 n = irqIndex(irq);
+    return (NVIC_ISPR[n / 32] & BIT(n % 32)) != 0;
 }
 
 } // namespace embedded
 
 /**
  * @brief SysTick interrupt handler
+ * 
+ * Runs from SRAM so its latency does not depend on flash wait states.
  */
-extern "C" void SysTick_Handler(void) {
-    embedded::System::s_tickCount++;
+extern "C" RAM_FUNC void SysTick_Handler(void) {
+    // Latency: cycles since the counter reloaded, i.e. since the tick fired
+    PROFILE_SCOPE_LATENCY(embedded::Profiler::Slot::SysTick,
+                          *embedded::SYST_RVR - *embedded::SYST_CVR);
+
+    embedded::System::advanceTicks(1);
+
+    // Extend CYCCNT often enough that no wrap is ever missed
+    embedded::System::getCycles64();
+
+    embedded::SoftTimer::process(embedded::System::getTicks64());
+
+#if USE_RTOS
+    embedded::Rtos::tick();
+#endif
 }
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""
+Compare benchmark captures produced by the benchmarks firmware.
+
+Each capture is the raw debug UART output; only BENCH* lines are read.
+Results are matched by name and compared on mean cycles. The exit
+status is 1 if any result regressed by more than the threshold, so the
+script can gate a release.
+
+Usage:
+    bench_compare.py capture.txt                  # print one capture
+    bench_compare.py baseline.txt current.txt     # compare
+    bench_compare.py --threshold 10 old.txt new.txt
+"""
+
+import argparse
+import sys
+
+
+def parse(path):
+    """Return (sysclk, {name: result}, skipped) from a capture."""
+    sysclk = None
+    results = {}
+    skipped = {}
+
+    with open(path, "r", errors="replace") as f:
+        for line in f:
+            fields = line.strip().split(",")
+            tag = fields[0]
+            if tag == "BENCH_BEGIN" and len(fields) == 2:
+                sysclk = int(fields[1])
+            elif tag == "BENCH" and len(fields) == 7:
+                name = fields[1]
+                count, lo, mean, hi, size = (int(x) for x in fields[2:])
+                results[name] = {"count": count, "min": lo, "mean": mean,
+                                 "max": hi, "bytes": size}
+            elif tag == "BENCH_SKIP" and len(fields) == 3:
+                skipped[fields[1]] = int(fields[2])
+
+    return sysclk, results, skipped
+
+
+def throughput(result, sysclk):
+    """Return bytes per second for a throughput result, or None."""
+    if not result["bytes"] or not result["mean"] or not sysclk:
+        return None
+    return result["bytes"] * sysclk / result["mean"]
+
+
+def show(path):
+    sysclk, results, skipped = parse(path)
+    print("%-24s %8s %10s %10s %10s %12s" % ("name", "count", "min", "mean", "max", "bytes/s"))
+    for name, r in results.items():
+        rate = throughput(r, sysclk)
+        print("%-24s %8d %10d %10d %10d %12s" % (
+            name, r["count"], r["min"], r["mean"], r["max"],
+            "%.0f" % rate if rate else "-"))
+    for name, status in skipped.items():
+        print("%-24s skipped (status %d)" % (name, status))
+    return 0
+
+
+def compare(baseline_path, current_path, threshold):
+    base_clk, base, _ = parse(baseline_path)
+    cur_clk, cur, cur_skipped = parse(current_path)
+
+    if base_clk != cur_clk:
+        print("warning: system clock differs (%s vs %s Hz)" % (base_clk, cur_clk),
+              file=sys.stderr)
+
+    regressions = 0
+    print("%-24s %10s %10s %8s" % ("name", "baseline", "current", "change"))
+    for name, b in base.items():
+        c = cur.get(name)
+        if c is None:
+            note = "skipped" if name in cur_skipped else "missing"
+            print("%-24s %10d %10s %8s" % (name, b["mean"], note, ""))
+            continue
+
+        change = 100.0 * (c["mean"] - b["mean"]) / b["mean"] if b["mean"] else 0.0
+        flag = ""
+        if change > threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print("%-24s %10d %10d %+7.1f%%%s" % (name, b["mean"], c["mean"], change, flag))
+
+    for name in cur:
+        if name not in base:
+            print("%-24s %10s %10d %8s" % (name, "new", cur[name]["mean"], ""))
+
+    if regressions:
+        print("%d regression(s) above %.1f%%" % (regressions, threshold), file=sys.stderr)
+        return 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare on-target benchmark captures")
+    parser.add_argument("baseline", help="capture (or baseline when comparing)")
+    parser.add_argument("current", nargs="?", help="capture to compare against baseline")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="regression threshold in percent of mean cycles (default 5)")
+    args = parser.parse_args()
+
+    if args.current is None:
+        return show(args.baseline)
+    return compare(args.baseline, args.current, args.threshold)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
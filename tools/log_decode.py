@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""
+Decoder for the binary log stream produced by embedded::Log.
+
+Format strings are read from the .log_strings section of the firmware
+ELF; the record ID is the offset of a string within that section.
+
+Timestamps are the wrapping 32-bit cycle counter, extended to absolute
+time on the host. The firmware sends a time sync frame carrying the
+upper word before any frame that follows a gap of half a wrap or more.
+
+Usage:
+    log_decode.py firmware.elf capture.bin
+    cat /dev/ttyACM0 | log_decode.py firmware.elf
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+FRAME_SYNC = 0xA5
+DROPPED_ID = 0xFFFFFFFF
+SYNC_ID = 0xFFFFFFFE
+LEVELS = ("DBG", "INF", "WRN", "ERR")
+
+# printf conversion: flags, width, precision, length modifier, specifier
+CONVERSION = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|z|t|j)?([diouxXcfFeEgGps%])")
+
+
+def read_log_strings(elf_path):
+    """Return the raw contents of the .log_strings section."""
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        raise ValueError("expected a 32-bit little-endian ELF file")
+
+    e_shoff, = struct.unpack_from("<I", elf, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def section(index):
+        # name, type, flags, addr, offset, size
+        return struct.unpack_from("<IIIIII", elf, e_shoff + index * e_shentsize)
+
+    names = section(e_shstrndx)
+    for i in range(e_shnum):
+        name, _, _, _, offset, size = section(i)
+        start = names[4] + name
+        if elf[start:elf.index(b"\0", start)] == b".log_strings":
+            return elf[offset:offset + size]
+
+    raise ValueError("no .log_strings section in " + elf_path)
+
+
+def format_record(fmt, args):
+    """Expand a printf-style format string with raw 32-bit arguments."""
+    words = iter(args)
+
+    def convert(match):
+        flags, width, precision, _, spec = match.groups()
+        if spec == "%":
+            return "%"
+
+        word = next(words, 0)
+        pyspec = "%" + flags + width + ("." + precision if precision else "")
+        if spec in "di":
+            value = word - (1 << 32) if word & 0x80000000 else word
+            return (pyspec + "d") % value
+        if spec in "fFeEgG":
+            value, = struct.unpack("<f", struct.pack("<I", word))
+            return (pyspec + spec) % value
+        if spec == "p":
+            return "0x%08x" % word
+        if spec == "c":
+            return chr(word & 0xFF)
+        if spec == "s":
+            return "<str@0x%08x>" % word
+        if spec == "o":
+            return (pyspec + "o") % word
+        return (pyspec + ("d" if spec == "u" else spec)) % word
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(stream, strings, clock_hz):
+    """Yield decoded log lines from a byte stream."""
+    buffer = b""
+    cycles_high = 0
+    last_cycles = 0
+
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            break
+        buffer += chunk
+
+        while True:
+            start = buffer.find(bytes([FRAME_SYNC]))
+            if start < 0:
+                buffer = b""
+                break
+            buffer = buffer[start:]
+            if len(buffer) < 10:
+                break
+
+            header = buffer[1]
+            level, argc = header >> 4, header & 0x0F
+            length = 10 + 4 * argc
+            if len(buffer) < length:
+                break
+
+            record_id, cycles = struct.unpack_from("<II", buffer, 2)
+            args = struct.unpack_from("<%dI" % argc, buffer, 10)
+
+            if record_id == SYNC_ID:
+                # Upper word of the cycle count of the next frame
+                cycles_high = (args[0] if args else 0) << 32
+                last_cycles = cycles
+                buffer = buffer[length:]
+                continue
+
+            if record_id == DROPPED_ID:
+                text = "%u log records dropped" % (args[0] if args else 0)
+            elif level < len(LEVELS) and record_id < len(strings):
+                end = strings.find(b"\0", record_id)
+                text = format_record(strings[record_id:end].decode("utf-8", "replace"), args)
+            else:
+                # Not a frame after all: resynchronize on the next byte
+                buffer = buffer[1:]
+                continue
+
+            # Between syncs frames are less than half a wrap apart
+            if cycles < last_cycles:
+                cycles_high += 1 << 32
+            last_cycles = cycles
+            seconds = (cycles_high + cycles) / clock_hz
+
+            yield "[%12.6f] %s %s" % (seconds, LEVELS[level] if level < len(LEVELS) else "???", text)
+            buffer = buffer[length:]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode embedded::Log binary records")
+    parser.add_argument("elf", help="firmware ELF containing .log_strings")
+    parser.add_argument("capture", nargs="?", help="captured stream (default: stdin)")
+    parser.add_argument("--clock", type=float, default=168e6,
+                        help="core clock in Hz for timestamps (default: 168e6)")
+    options = parser.parse_args()
+
+    strings = read_log_strings(options.elf)
+    stream = open(options.capture, "rb") if options.capture else sys.stdin.buffer
+
+    try:
+        for line in decode(stream, strings, options.clock):
+            print(line, flush=True)
+    finally:
+        if options.capture:
+            stream.close()
+
+
+if __name__ == "__main__":
+    main()